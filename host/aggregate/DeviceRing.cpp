@@ -0,0 +1,78 @@
+#include "DeviceRing.h"
+
+namespace aggregate {
+
+    DeviceRing::DeviceRing() : head(0), newestMicros(0) {
+        for (uint64_t i = 0; i < RingCapacity; i++) {
+            slots[i].sequence.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    bool DeviceRing::push(const Sample& sample) {
+        const uint64_t index = head.load(std::memory_order_relaxed);
+        if (index != 0 && sample.micros <= newestMicros) {
+            return false; // bracket() needs them in time order
+        }
+        newestMicros = sample.micros;
+        Slot& slot = slots[index & (RingCapacity - 1)];
+        slot.sequence.store(0, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        slot.sample = sample;
+        slot.sequence.store(index + 1, std::memory_order_release);
+        head.store(index + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool DeviceRing::load(uint64_t index, Sample& outSample) const {
+        const Slot& slot = slots[index & (RingCapacity - 1)];
+        const uint64_t before = slot.sequence.load(std::memory_order_acquire);
+        if (before != index + 1) {
+            return false; // overwritten or not written yet
+        }
+        outSample = slot.sample;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return slot.sequence.load(std::memory_order_relaxed) == before;
+    }
+
+    bool DeviceRing::newest(Sample& outSample) const {
+        const uint64_t h = head.load(std::memory_order_acquire);
+        return h != 0 && load(h - 1, outSample);
+    }
+
+    bool DeviceRing::bracket(uint64_t micros, Sample& outBefore, Sample& outAfter) const {
+        const uint64_t h = head.load(std::memory_order_acquire);
+        if (h == 0) {
+            return false; // no sample
+        }
+        uint64_t hi = h - 1;
+        if (!load(hi, outAfter)) {
+            return false;
+        }
+        if (micros >= outAfter.micros) {
+            outBefore = outAfter;
+            return true;
+        }
+        uint64_t lo = (h > RingCapacity - RingGuard) ? h - (RingCapacity - RingGuard) : 0;
+        if (!load(lo, outBefore)) {
+            return false;
+        }
+        if (micros < outBefore.micros) {
+            return false; // older than the ring holds
+        }
+        // samples[lo] <= micros < samples[hi]
+        Sample probe;
+        while (hi - lo > 1) {
+            const uint64_t mid = lo + (hi - lo) / 2;
+            if (!load(mid, probe)) {
+                return false;
+            }
+            if (probe.micros <= micros) {
+                lo = mid;
+            } else {
+                hi = mid;
+            }
+        }
+        return load(lo, outBefore) && load(hi, outAfter);
+    }
+
+} // aggregate
@@ -0,0 +1,47 @@
+#ifndef __AGGREGATE_DEVICE_RING_H__
+#define __AGGREGATE_DEVICE_RING_H__
+
+#include <inttypes.h>
+#include <atomic>
+#include "imu/ImuData.h"
+
+namespace aggregate {
+
+static const int CacheLineSize = 64;
+static const uint64_t RingCapacity = 512;  // power of 2, 2.56[s] at 200[Hz]
+static const uint64_t RingGuard = 16;      // slots kept away from the writer
+
+struct Sample {
+public:
+    uint64_t micros;  // [us] receiver clock
+    float acc[imu::ImuXyz];
+    float gyro[imu::ImuXyz];
+    float quat[imu::ImuWxyz];
+};
+
+// Lock free ring of one device. One writer pushes, any number of readers look
+// up the samples around a time. Each slot has a sequence number (seqlock) so a
+// reader detects a slot overwritten while it was copied.
+// The samples are kept in time order, a sample not newer than the newest one
+// (a resent frame or another clock of the device) is dropped.
+class alignas(CacheLineSize) DeviceRing {
+public:
+    explicit DeviceRing();
+    bool push(const Sample& sample);
+    bool newest(Sample& outSample) const;
+    bool bracket(uint64_t micros, Sample& outBefore, Sample& outAfter) const;
+    uint64_t count() const { return head.load(std::memory_order_acquire); }
+private:
+    struct alignas(CacheLineSize) Slot {
+        std::atomic<uint64_t> sequence;
+        Sample sample;
+    };
+    std::atomic<uint64_t> head;
+    uint64_t newestMicros;  // of the writer only
+    Slot slots[RingCapacity];
+    bool load(uint64_t index, Sample& outSample) const;
+};
+
+} // aggregate
+
+#endif // __AGGREGATE_DEVICE_RING_H__
@@ -0,0 +1,204 @@
+#include <math.h>
+#include <string.h>
+#include "FrameStore.h"
+#include "imu/ImuBatchData.h"
+#include "imu/ImuMotionData.h"
+#include "session/SessionDefine.h"
+#include "timesync/TimeSyncData.h"
+
+namespace aggregate {
+
+    static void toSample(const imu::ImuData& imuData, uint64_t micros, Sample& outSample) {
+        outSample.micros = micros;
+        memcpy(outSample.acc, imuData.acc, sizeof(float) * imu::ImuXyz);
+        memcpy(outSample.gyro, imuData.gyro, sizeof(float) * imu::ImuXyz);
+        memcpy(outSample.quat, imuData.quat, sizeof(float) * imu::ImuWxyz);
+    }
+
+    FrameStore::FrameStore(int maxDevices) : keys(maxDevices, 0), count(0) {
+        rings.reserve(maxDevices);
+        for (int i = 0; i < maxDevices; i++) {
+            rings.emplace_back(new DeviceRing());
+        }
+    }
+
+    int FrameStore::addDevice(uint64_t key) {
+        std::lock_guard<std::mutex> lock(addMutex);
+        const int found = findDevice(key);
+        if (found >= 0) {
+            return found;
+        }
+        const int n = count.load(std::memory_order_relaxed);
+        if (n >= (int)rings.size()) {
+            return -1; // full
+        }
+        keys[n] = key;
+        count.store(n + 1, std::memory_order_release);
+        return n;
+    }
+
+    int FrameStore::findDevice(uint64_t key) const {
+        const int n = deviceCount();
+        for (int i = 0; i < n; i++) {
+            if (keys[i] == key) {
+                return i;
+            }
+        }
+        return -1;
+    }
+
+    bool FrameStore::push(int device, const Sample& sample) {
+        if (device < 0 || device >= deviceCount()) {
+            return false;
+        }
+        return rings[device]->push(sample);
+    }
+
+    bool FrameStore::pushFrame(int device, const uint8_t* frame, size_t len, uint64_t receivedMicros) {
+        if (len < session::data_length::header) {
+            return false;
+        }
+        uint16_t dataType = 0;
+        uint16_t dataLength = 0;
+        memcpy(&dataType, frame, sizeof(uint16_t));
+        memcpy(&dataLength, frame + sizeof(uint16_t), sizeof(uint16_t));
+        if (len < (size_t)session::data_length::header + dataLength) {
+            return false;
+        }
+        const uint8_t* payload = frame + session::data_length::header;
+        Sample sample;
+        imu::ImuData imuData;
+        if (dataType == session::data_type::timedImu &&
+            dataLength == session::data_length::timedImu) {
+            uint64_t micros = 0;
+            memcpy(&micros, payload, sizeof(uint64_t));
+            memcpy(&imuData, payload + sizeof(uint64_t), imu::ImuDataLen);
+            toSample(imuData, micros, sample);
+            return push(device, sample);
+        } else if (dataType == session::data_type::imu &&
+                   dataLength == session::data_length::imu) {
+            // device millis is not in the receiver clock
+            memcpy(&imuData, payload, imu::ImuDataLen);
+            toSample(imuData, receivedMicros, sample);
+            return push(device, sample);
+        } else if (dataType == session::data_type::imuMotion &&
+                   dataLength == session::data_length::imuMotion) {
+            uint64_t micros = 0;
+            uint32_t flags = 0;
+            memcpy(&micros, payload, sizeof(uint64_t));
+            memcpy(&imuData, payload + sizeof(uint64_t), imu::ImuDataLen);
+            memcpy(&flags, payload + imu::ImuMotionDataLen - sizeof(uint32_t), sizeof(uint32_t));
+            toSample(imuData, (flags & imu::MotionFlagShared) ? micros : receivedMicros, sample);
+            return push(device, sample);
+        } else if (dataType == session::data_type::imuBatch) {
+            return pushBatch(device, payload, dataLength, receivedMicros);
+        }
+        return false;
+    }
+
+    bool FrameStore::pushBatch(int device, const uint8_t* payload, uint16_t len, uint64_t receivedMicros) {
+        if (len < imu::ImuBatchHeaderLen) {
+            return false;
+        }
+        uint64_t base = 0;
+        memcpy(&base, payload, sizeof(uint64_t));
+        const uint8_t sampleCount = payload[sizeof(uint64_t)];
+        const uint8_t flags = payload[sizeof(uint64_t) + 1];
+        if (sampleCount == 0 || sampleCount > imu::ImuBatchMax ||
+            len != imu::ImuBatchHeaderLen + imu::ImuBatchSampleLen * sampleCount) {
+            return false;
+        }
+        const uint8_t* samples = payload + imu::ImuBatchHeaderLen;
+        uint32_t lastDelta = 0;
+        memcpy(&lastDelta, samples + imu::ImuBatchSampleLen * (sampleCount - 1), sizeof(uint32_t));
+        Sample sample;
+        imu::ImuData imuData;
+        int pushed = 0;
+        for (int i = 0; i < sampleCount; i++) {
+            const uint8_t* entry = samples + imu::ImuBatchSampleLen * i;
+            uint32_t delta = 0;
+            memcpy(&delta, entry, sizeof(uint32_t));
+            memcpy(&imuData, entry + sizeof(uint32_t), imu::ImuDataLen);
+            // without the shared clock the last sample is taken as received now
+            const uint64_t micros = (flags & imu::ImuBatchFlagShared)
+                                        ? base + delta : receivedMicros - (lastDelta - delta);
+            toSample(imuData, micros, sample);
+            pushed += push(device, sample) ? 1 : 0;
+        }
+        return pushed > 0;
+    }
+
+    void FrameStore::snapshot(uint64_t micros, SkeletonSnapshot& outSnapshot) const {
+        const int n = deviceCount();
+        outSnapshot.micros = micros;
+        outSnapshot.devices.resize(n);
+        Sample before, after, newest;
+        for (int i = 0; i < n; i++) {
+            DeviceState& state = outSnapshot.devices[i];
+            const DeviceRing& ring = *rings[i];
+            state.valid = ring.bracket(micros, before, after) && ring.newest(newest);
+            if (!state.valid) {
+                continue;
+            }
+            state.staleness = (micros > newest.micros) ? micros - newest.micros : 0;
+            float t = 0.0F;
+            if (after.micros > before.micros) {
+                t = (float)(micros - before.micros) / (float)(after.micros - before.micros);
+            }
+            for (int j = 0; j < imu::ImuXyz; j++) {
+                state.acc[j] = before.acc[j] + (after.acc[j] - before.acc[j]) * t;
+                state.gyro[j] = before.gyro[j] + (after.gyro[j] - before.gyro[j]) * t;
+            }
+            slerp(before.quat, after.quat, t, state.quat);
+        }
+    }
+
+    SnapshotClock::SnapshotClock(double rateHz, uint64_t delayMicros)
+        : interval((uint64_t)(1000000.0 / rateHz)), delay(delayMicros), next(0) { }
+
+    bool SnapshotClock::due(uint64_t nowMicros, uint64_t& outMicros) {
+        if (nowMicros < next) {
+            return false;
+        }
+        const uint64_t scheduled = next;
+        next += interval;
+        if (nowMicros >= next + interval) {
+            next = nowMicros; // fell behind, skip the missed outputs
+        }
+        if (scheduled < delay) {
+            return false;
+        }
+        outMicros = scheduled - delay;
+        return true;
+    }
+
+    void slerp(const float* from, const float* to, float t, float* outQuat) {
+        float cosTheta = from[0] * to[0] + from[1] * to[1] + from[2] * to[2] + from[3] * to[3];
+        float sign = 1.0F;
+        if (cosTheta < 0.0F) {
+            // take the shorter path
+            cosTheta = -cosTheta;
+            sign = -1.0F;
+        }
+        float wf = 1.0F - t;
+        float wt = t;
+        // close quaternions fall back to nlerp
+        if (cosTheta < 0.9995F) {
+            const float theta = acosf(cosTheta);
+            const float recipSin = 1.0F / sinf(theta);
+            wf = sinf(wf * theta) * recipSin;
+            wt = sinf(wt * theta) * recipSin;
+        }
+        wt *= sign;
+        float norm = 0.0F;
+        for (int i = 0; i < imu::ImuWxyz; i++) {
+            outQuat[i] = wf * from[i] + wt * to[i];
+            norm += outQuat[i] * outQuat[i];
+        }
+        norm = 1.0F / sqrtf(norm);
+        for (int i = 0; i < imu::ImuWxyz; i++) {
+            outQuat[i] *= norm;
+        }
+    }
+
+} // aggregate
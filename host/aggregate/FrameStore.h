@@ -0,0 +1,67 @@
+#ifndef __AGGREGATE_FRAME_STORE_H__
+#define __AGGREGATE_FRAME_STORE_H__
+
+#include <inttypes.h>
+#include <stddef.h>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "DeviceRing.h"
+
+namespace aggregate {
+
+struct DeviceState {
+public:
+    bool valid;
+    uint64_t staleness;  // [us] from the newest sample of the device
+    float acc[imu::ImuXyz];
+    float gyro[imu::ImuXyz];
+    float quat[imu::ImuWxyz];
+};
+
+struct SkeletonSnapshot {
+public:
+    uint64_t micros;  // [us] receiver clock
+    std::vector<DeviceState> devices;
+};
+
+// Keeps a DeviceRing per device and makes time aligned snapshots of all of
+// them. acc and gyro are interpolated linearly and quat by slerp, a device
+// without a newer sample holds its newest one and reports the staleness, a
+// time older than its ring holds is not valid. push() returns false for a
+// sample not newer than the newest one of the device.
+class FrameStore {
+public:
+    explicit FrameStore(int maxDevices);
+    int addDevice(uint64_t key);
+    int findDevice(uint64_t key) const;
+    int deviceCount() const { return count.load(std::memory_order_acquire); }
+    bool push(int device, const Sample& sample);
+    bool pushFrame(int device, const uint8_t* frame, size_t len, uint64_t receivedMicros);
+    void snapshot(uint64_t micros, SkeletonSnapshot& outSnapshot) const;
+private:
+    std::vector<std::unique_ptr<DeviceRing>> rings;
+    std::vector<uint64_t> keys;
+    std::atomic<int> count;
+    std::mutex addMutex;
+    bool pushBatch(int device, const uint8_t* payload, uint16_t len, uint64_t receivedMicros);
+};
+
+// Gives the snapshot times at a fixed output rate. The snapshots are taken
+// delay behind the receiver clock so that every device has a sample after them.
+class SnapshotClock {
+public:
+    explicit SnapshotClock(double rateHz, uint64_t delayMicros);
+    bool due(uint64_t nowMicros, uint64_t& outMicros);
+private:
+    uint64_t interval;
+    uint64_t delay;
+    uint64_t next;
+};
+
+void slerp(const float* from, const float* to, float t, float* outQuat);
+
+} // aggregate
+
+#endif // __AGGREGATE_FRAME_STORE_H__
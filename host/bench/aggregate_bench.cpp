@@ -0,0 +1,173 @@
+// Feeds simulated timedImu frames of many devices into aggregate::FrameStore
+// and takes snapshots at the output rate, all on one thread. Some devices drop
+// frames, some deliver them later than the snapshot delay and some go silent
+// for a while, so that the held samples and the staleness are exercised.
+// The dropping devices also resend some frames, which have to be refused.
+// Some devices send imuMotion frames in the receiver clock instead.
+// Each device rotates about z at a constant rate, the interpolated quat is
+// checked against the analytic one and the held quat against the one at its
+// staleness. Fails when either is off, no device was ever stale, a frame was
+// refused or a resent frame was taken.
+//   g++ -std=c++17 -O2 -I src -I host host/bench/aggregate_bench.cpp host/aggregate/*.cpp -o aggregate_bench
+//   ./aggregate_bench [devices] [input Hz] [output Hz] [seconds]
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <string.h>
+#include <chrono>
+#include <random>
+#include "aggregate/FrameStore.h"
+#include "imu/ImuMotionData.h"
+#include "session/SessionData.h"
+#include "timesync/TimeSyncData.h"
+
+static const uint64_t SnapshotDelay = 20000;   // [us]
+static const uint64_t LateDelay = 30000;       // [us] longer than SnapshotDelay
+static const uint64_t SilentPeriod = 10000000; // [us]
+static const uint64_t SilentLength = 1000000;  // [us]
+static const double DropRate = 0.05;
+static const double ResendRate = 0.05;
+static const double MaxQuatError = 1e-4;       // [rad]
+
+static bool isDropping(int device) { return device % 8 == 7; }
+static bool isLate(int device) { return device % 8 == 3; }
+static bool isMotion(int device) { return device % 8 == 1; }
+static bool isSilent(int device, uint64_t now) {
+    return device % 16 == 5 && now % SilentPeriod >= SilentPeriod - SilentLength;
+}
+
+// rotation about z at 1[rad/s], every device at its own start angle
+static double angleAt(int device, uint64_t micros) {
+    return (double)micros * 1e-6 + device;
+}
+
+// rotation angle of conj(expected) * quat, atan2 keeps it precise near 0
+static double quatError(const float* quat, double angle) {
+    const double c = cos(angle * 0.5);
+    const double s = sin(angle * 0.5);
+    const double w = c * quat[0] + s * quat[3];
+    const double x = c * quat[1] + s * quat[2];
+    const double y = c * quat[2] - s * quat[1];
+    const double z = c * quat[3] - s * quat[0];
+    return 2.0 * atan2(sqrt(x * x + y * y + z * z), fabs(w));
+}
+
+int main(int argc, char** argv) {
+    const int devices = (argc > 1) ? atoi(argv[1]) : 64;
+    const double inputHz = (argc > 2) ? atof(argv[2]) : 200.0;
+    const double outputHz = (argc > 3) ? atof(argv[3]) : 200.0;
+    const int seconds = (argc > 4) ? atoi(argv[4]) : 60;
+
+    aggregate::FrameStore store(devices);
+    for (int i = 0; i < devices; i++) {
+        store.addDevice(i);
+    }
+    aggregate::SnapshotClock snapshotClock(outputHz, SnapshotDelay);
+    aggregate::SkeletonSnapshot snapshot;
+    session::SessionData timedFrame(session::DataDefineTimedImu);
+    session::SessionData motionFrame(session::DataDefineImuMotion);
+    timesync::TimedImuData timed;
+    imu::ImuMotionData motion;
+    motion.flags = imu::MotionFlagShared;
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+
+    // every device samples at its own phase
+    const uint64_t inputInterval = (uint64_t)(1000000.0 / inputHz);
+    const uint64_t end = (uint64_t)seconds * 1000000ULL;
+    uint64_t frames = 0;
+    uint64_t dropped = 0;
+    uint64_t refused = 0;
+    uint64_t resent = 0;
+    uint64_t resentTaken = 0;
+    uint64_t snapshots = 0;
+    uint64_t states = 0;
+    uint64_t invalid = 0;
+    uint64_t stale = 0;
+    uint64_t staleness = 0;
+    uint64_t maxStaleness = 0;
+    double maxInterpolated = 0.0;
+    double maxHeld = 0.0;
+    double pushSeconds = 0.0;
+    double snapshotSeconds = 0.0;
+    typedef std::chrono::steady_clock Clock;
+    for (uint64_t now = 0; now < end; now += 100) {
+        for (int i = 0; i < devices; i++) {
+            const uint64_t lag = isLate(i) ? LateDelay : 0;
+            const uint64_t phase = lag + (uint64_t)i * inputInterval / devices / 100 * 100;
+            if (now < phase || (now - phase) % inputInterval != 0) {
+                continue;
+            }
+            if (isSilent(i, now) || (isDropping(i) && uniform(rng) < DropRate)) {
+                dropped++;
+                continue;
+            }
+            const uint64_t sampled = now - lag;
+            const double angle = angleAt(i, sampled);
+            timed.micros = sampled;
+            timed.imu.timestamp = (uint32_t)(sampled / 1000);
+            timed.imu.quat[0] = (float)cos(angle * 0.5);
+            timed.imu.quat[3] = (float)sin(angle * 0.5);
+            session::SessionData& frame = isMotion(i) ? motionFrame : timedFrame;
+            if (isMotion(i)) {
+                motion.micros = timed.micros;
+                motion.imu = timed.imu;
+                frame.write((uint8_t*)&motion, imu::ImuMotionDataLen);
+            } else {
+                frame.write((uint8_t*)&timed, timesync::TimedImuDataLen);
+            }
+            auto pushStart = Clock::now();
+            refused += store.pushFrame(i, (uint8_t*)&frame, frame.length(), now) ? 0 : 1;
+            pushSeconds += std::chrono::duration<double>(Clock::now() - pushStart).count();
+            frames++;
+            if (isDropping(i) && uniform(rng) < ResendRate) {
+                resent++;
+                resentTaken += store.pushFrame(i, (uint8_t*)&frame, frame.length(), now) ? 1 : 0;
+            }
+        }
+        uint64_t at = 0;
+        if (!snapshotClock.due(now, at)) {
+            continue;
+        }
+        auto snapshotStart = Clock::now();
+        store.snapshot(at, snapshot);
+        snapshotSeconds += std::chrono::duration<double>(Clock::now() - snapshotStart).count();
+        snapshots++;
+        for (int i = 0; i < devices; i++) {
+            const aggregate::DeviceState& state = snapshot.devices[i];
+            states++;
+            if (!state.valid) {
+                invalid++;
+                continue;
+            }
+            // a held sample is the newest one, at its staleness
+            const double error = quatError(state.quat, angleAt(i, at - state.staleness));
+            if (state.staleness > 0) {
+                stale++;
+                staleness += state.staleness;
+                maxStaleness = (state.staleness > maxStaleness) ? state.staleness : maxStaleness;
+                maxHeld = fmax(maxHeld, error);
+            } else {
+                maxInterpolated = fmax(maxInterpolated, error);
+            }
+        }
+    }
+    const double elapsed = pushSeconds + snapshotSeconds;
+    printf("devices=%d input=%.0fHz output=%.0fHz simulated=%ds\n", devices, inputHz, outputHz, seconds);
+    printf("frames=%llu dropped=%llu snapshots=%llu elapsed=%.3fs (%.2f%% of one core)\n",
+           (unsigned long long)frames, (unsigned long long)dropped, (unsigned long long)snapshots,
+           elapsed, elapsed * 100.0 / seconds);
+    printf("refused=%llu resent=%llu taken=%llu\n", (unsigned long long)refused,
+           (unsigned long long)resent, (unsigned long long)resentTaken);
+    printf("push=%.0fns/frame snapshot=%.1fus\n",
+           pushSeconds * 1e9 / (frames ? frames : 1), snapshotSeconds * 1e6 / (snapshots ? snapshots : 1));
+    printf("invalid=%llu stale=%llu/%llu mean staleness=%.0fus max staleness=%lluus\n",
+           (unsigned long long)invalid, (unsigned long long)stale, (unsigned long long)states,
+           (double)staleness / (stale ? stale : 1), (unsigned long long)maxStaleness);
+
+    const bool exercised = stale > 0 || devices <= 3;
+    const bool ok = exercised && refused == 0 && resentTaken == 0 && maxInterpolated <= MaxQuatError && maxHeld <= MaxQuatError;
+    printf("max quat error interpolated=%.2erad held=%.2erad: %s\n",
+           maxInterpolated, maxHeld, ok ? "ok" : "FAILED");
+    return ok ? 0 : 1;
+}
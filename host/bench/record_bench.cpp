@@ -0,0 +1,137 @@
+// Writes a simulated multi device capture with record::RecordWriter, then
+// measures random seeks with record::RecordReader. Each seek has to give the
+// first record of the stream at or after the time. The seeks are run again
+// on the file cut off in the middle, as if the writer was killed.
+//   g++ -std=c++11 -O2 -I src -I host host/bench/record_bench.cpp host/record/*.cpp -o record_bench
+//   ./record_bench [path] [devices] [Hz] [hours] [seeks]
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <vector>
+#include "record/RecordReader.h"
+#include "record/RecordWriter.h"
+#include "session/SessionData.h"
+#include "timesync/TimeSyncData.h"
+
+typedef std::chrono::steady_clock Clock;
+
+static double secondsSince(Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+// random seeks per stream, a stream samples at interval from its own phase
+static int runSeeks(const record::RecordReader& reader, int devices, uint64_t interval,
+                    uint64_t end, int seeks, const char* name) {
+    std::mt19937_64 rng(1);
+    std::uniform_int_distribution<uint64_t> target(reader.firstMicros(), reader.lastMicros());
+    std::vector<double> latencies(seeks);
+    int wrong = 0;
+    record::RecordView view;
+    for (int i = 0; i < seeks; i++) {
+        const uint64_t micros = target(rng);
+        const int stream = i % devices;
+        Clock::time_point start = Clock::now();
+        record::RecordCursor cursor = reader.seek(micros, stream);
+        const bool found = cursor.next(view);
+        latencies[i] = secondsSince(start) * 1e6;
+        // the first record of the stream at or after micros
+        const uint64_t phase = (uint64_t)stream * interval / devices;
+        const uint64_t k = (micros <= phase) ? 0 : (micros - phase + interval - 1) / interval;
+        const uint64_t expected = k * interval + phase;
+        const bool exists = k * interval < end && expected <= reader.lastMicros();
+        if (found != exists || (found && (view.micros != expected || view.stream != stream))) {
+            wrong++;
+        }
+    }
+    // out of the stream mask
+    record::RecordCursor outOfRange = reader.seek(reader.firstMicros(), record::MaxStreams);
+    if (outOfRange.next(view)) {
+        wrong++;
+    }
+    std::sort(latencies.begin(), latencies.end());
+    double sum = 0.0;
+    for (int i = 0; i < seeks; i++) {
+        sum += latencies[i];
+    }
+    printf("%s: n=%d mean=%.2fus p50=%.2fus p99=%.2fus max=%.2fus wrong=%d\n",
+           name, seeks, sum / seeks, latencies[seeks / 2], latencies[seeks * 99 / 100],
+           latencies[seeks - 1], wrong);
+    return wrong;
+}
+
+int main(int argc, char** argv) {
+    const char* path = (argc > 1) ? argv[1] : "/tmp/ryap_bench.rec";
+    const int devices = (argc > 2) ? atoi(argv[2]) : 8;
+    const double hz = (argc > 3) ? atof(argv[3]) : 200.0;
+    const double hours = (argc > 4) ? atof(argv[4]) : 2.0;
+    const int seeks = (argc > 5) ? atoi(argv[5]) : 100000;
+
+    // write
+    record::RecordWriter writer;
+    if (!writer.open(path, 0)) {
+        perror(path);
+        return 1;
+    }
+    for (int i = 0; i < devices; i++) {
+        writer.addStream(0xc0a80000ULL + i);
+    }
+    session::SessionData frame(session::DataDefineTimedImu);
+    timesync::TimedImuData timed;
+    const uint64_t interval = (uint64_t)(1000000.0 / hz);
+    const uint64_t end = (uint64_t)(hours * 3600.0 * 1000000.0);
+    uint64_t records = 0;
+    Clock::time_point start = Clock::now();
+    for (uint64_t now = 0; now < end; now += interval) {
+        for (int i = 0; i < devices; i++) {
+            timed.micros = now + (uint64_t)i * interval / devices;
+            timed.imu.timestamp = (uint32_t)(timed.micros / 1000);
+            timed.imu.acc[2] = 1.0F;
+            frame.write((uint8_t*)&timed, timesync::TimedImuDataLen);
+            writer.write(i, timed.micros, (uint8_t*)&frame, (uint16_t)frame.length());
+            records++;
+        }
+    }
+    const uint64_t bytes = writer.bytesWritten();
+    writer.close();
+    const double writeSeconds = secondsSince(start);
+    printf("write: records=%llu size=%.1fMB %.2fs %.1fMB/s %.2fM records/s\n",
+           (unsigned long long)records, bytes / 1e6, writeSeconds,
+           bytes / 1e6 / writeSeconds, records / 1e6 / writeSeconds);
+
+    // open and seek
+    record::RecordReader reader;
+    start = Clock::now();
+    if (!reader.open(path)) {
+        fprintf(stderr, "failed to open %s\n", path);
+        return 1;
+    }
+    printf("open: chunks=%zu streams=%zu %.3fms\n", reader.chunkCount(),
+           reader.streamCount(), secondsSince(start) * 1e3);
+
+    int wrong = runSeeks(reader, devices, interval, end, seeks, "seek");
+    reader.close();
+
+    // cut off, without the footer and the last chunks
+    struct stat st;
+    if (stat(path, &st) != 0 || truncate(path, st.st_size * 3 / 4) != 0) {
+        perror(path);
+        return 1;
+    }
+    start = Clock::now();
+    if (!reader.open(path) || !reader.recovered()) {
+        fprintf(stderr, "failed to recover %s\n", path);
+        unlink(path);
+        return 1;
+    }
+    printf("recover: chunks=%zu streams=%zu %.3fms\n", reader.chunkCount(),
+           reader.streamCount(), secondsSince(start) * 1e3);
+    wrong += runSeeks(reader, devices, interval, end, seeks, "recovered seek");
+    reader.close();
+    unlink(path);
+    return wrong == 0 ? 0 : 1;
+}
@@ -0,0 +1,61 @@
+#include "DutyCycleModel.h"
+
+namespace power {
+
+    static double clampFraction(double value) {
+        return (value < 0.0) ? 0.0 : ((value > 1.0) ? 1.0 : value);
+    }
+
+    DutyCycle estimateDutyCycle(const PowerSetting& setting, double sampleHz,
+                                const PowerModel& model) {
+        DutyCycle duty;
+        const double mhz = setting.cpuMhz;
+        const int batch = (setting.batchSize > 0) ? setting.batchSize : 1;
+        const double timeSyncPerSecond = 1000.0 / setting.timeSyncInterval;
+        duty.packetsPerSecond = sampleHz / batch + model.telemetryPerSecond + timeSyncPerSecond;
+        // imu, button, read session, write session
+        duty.wakeUpsPerSecond = sampleHz + 2.0 * 1000.0 / setting.pollInterval +
+                                1000.0 / setting.sendInterval;
+        // out of power save and spinning while a time sync response is awaited
+        const double timeSyncAwait = timeSyncPerSecond * model.timeSyncAwaitMicros * 1e-6;
+
+        // radio
+        duty.radioTx = clampFraction(duty.packetsPerSecond * model.packetAirMicros * 1e-6);
+        double radioAwake = 1.0;
+        if (setting.powerSave != PowerSaveNone) {
+            const int beacons = (setting.powerSave == PowerSaveMaxModem && setting.listenInterval > 0)
+                                    ? setting.listenInterval : 1;
+            const double wakes = 1e6 / (model.beaconIntervalMicros * beacons);
+            radioAwake = clampFraction(
+                (wakes * model.beaconAwakeMicros +
+                 duty.packetsPerSecond * (model.packetAirMicros + model.packetTailMicros)) * 1e-6 +
+                timeSyncAwait);
+        }
+        duty.radioRx = clampFraction(radioAwake - duty.radioTx);
+
+        // cpu, auto light sleep only while the radio sleeps and only when the
+        // idle time between the wake ups (taken as even) is long enough
+        duty.cpuActive = clampFraction(
+            (sampleHz * (model.sampleBusMicros + model.sampleCycles / mhz) +
+             duty.packetsPerSecond * model.packetCycles / mhz) * 1e-6 + timeSyncAwait);
+        duty.cpuSleep = 0.0;
+        const double idleMicros = (1.0 - duty.cpuActive) * 1e6 / duty.wakeUpsPerSecond;
+        if (setting.lightSleep && setting.powerSave != PowerSaveNone &&
+            idleMicros >= model.sleepMinIdleMicros) {
+            const double wakeUp = duty.wakeUpsPerSecond * model.wakeUpMicros * 1e-6;
+            duty.cpuSleep = clampFraction((1.0 - duty.cpuActive) * (1.0 - radioAwake) - wakeUp);
+        }
+        duty.cpuIdle = clampFraction(1.0 - duty.cpuActive - duty.cpuSleep);
+
+        duty.milliamps =
+            model.baseMilliamps + model.displayMilliamps +
+            duty.cpuActive * (model.cpuActiveBase + model.cpuActivePerMhz * mhz) +
+            duty.cpuIdle * (model.cpuIdleBase + model.cpuIdlePerMhz * mhz) +
+            duty.cpuSleep * model.lightSleepMilliamps +
+            duty.radioTx * model.radioTxMilliamps +
+            duty.radioRx * model.radioRxMilliamps;
+        duty.batteryHours = model.batteryMilliampHours * model.batteryUsable / duty.milliamps;
+        return duty;
+    }
+
+} // power
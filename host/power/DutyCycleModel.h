@@ -0,0 +1,54 @@
+#ifndef __POWER_DUTY_CYCLE_MODEL_H__
+#define __POWER_DUTY_CYCLE_MODEL_H__
+
+#include "power/PowerProfile.h"
+
+namespace power {
+
+// Rough figures of an M5StickC [mA] and [us]. The currents follow the ESP32
+// datasheet, the times should be replaced with the telemetry of a real unit.
+struct PowerModel {
+public:
+    double batteryMilliampHours = 95.0;
+    double batteryUsable = 0.85;
+    double baseMilliamps = 5.0;          // pmic, imu
+    double displayMilliamps = 15.0;      // lcd backlight
+    double cpuActiveBase = 20.0;         // + cpuActivePerMhz * MHz
+    double cpuActivePerMhz = 0.2;
+    double cpuIdleBase = 20.0;           // + cpuIdlePerMhz * MHz
+    double cpuIdlePerMhz = 0.05;
+    double lightSleepMilliamps = 0.8;
+    double radioRxMilliamps = 95.0;
+    double radioTxMilliamps = 190.0;
+    double sampleBusMicros = 350.0;      // i2c, does not scale with the cpu clock
+    double sampleCycles = 20000.0;       // fusion
+    double packetCycles = 60000.0;       // lwip and driver
+    double packetAirMicros = 400.0;
+    double packetTailMicros = 5000.0;    // radio kept awake after a packet
+    double beaconIntervalMicros = 102400.0;
+    double beaconAwakeMicros = 3000.0;
+    double wakeUpMicros = 150.0;         // per light sleep wake up
+    double sleepMinIdleMicros = 3000.0;  // idle before light sleep, 3 ticks
+    double timeSyncAwaitMicros = 5000.0; // radio awake, read loop spinning
+    double telemetryPerSecond = 4.0;
+};
+
+struct DutyCycle {
+public:
+    double packetsPerSecond;
+    double wakeUpsPerSecond;  // of all tasks
+    double cpuActive;   // fraction of the time
+    double cpuIdle;
+    double cpuSleep;
+    double radioTx;
+    double radioRx;
+    double milliamps;
+    double batteryHours;
+};
+
+DutyCycle estimateDutyCycle(const PowerSetting& setting, double sampleHz,
+                            const PowerModel& model);
+
+} // power
+
+#endif // __POWER_DUTY_CYCLE_MODEL_H__
@@ -0,0 +1,72 @@
+#ifndef __RECORD_RECORD_FORMAT_H__
+#define __RECORD_RECORD_FORMAT_H__
+
+#include <inttypes.h>
+
+namespace record {
+
+// file   : FileHeader, chunk..., IndexEntry[chunkCount], StreamEntry[streamCount], Footer
+// chunk  : ChunkHeader, record..., uint32_t offsets[recordCount]
+// record : uint64_t micros, uint16_t stream, uint16_t length, session frame[length]
+// Records are in the order of micros over the whole file. offsets are from the
+// head of the chunk, so both the chunks and the records are binary searched.
+
+static const char FileMagic[8] = {'R', 'Y', 'A', 'P', 'R', 'E', 'C', '1'};
+static const char FooterMagic[8] = {'R', 'Y', 'A', 'P', 'E', 'N', 'D', '1'};
+static const uint32_t ChunkMagic = 0x4b4e4843;  // "CHNK"
+static const uint32_t FormatVersion = 1;
+static const uint32_t DefaultChunkBytes = 1 << 20;
+static const int MaxStreams = 64;               // bits of streamMask
+static const int RecordHeaderLen = 12;//8 + 2 + 2;
+
+struct FileHeader {
+public:
+    char magic[8];
+    uint32_t version;
+    uint32_t chunkBytes;
+    uint64_t createdMicros;
+};
+
+struct ChunkHeader {
+public:
+    uint32_t magic;
+    uint32_t recordCount;
+    uint32_t recordBytes;
+    uint32_t reserved;
+    uint64_t firstMicros;
+    uint64_t lastMicros;
+    uint64_t streamMask;  // bit n: the chunk has a record of stream n
+};
+
+struct IndexEntry {
+public:
+    uint64_t offset;
+    uint64_t firstMicros;
+    uint64_t lastMicros;
+    uint64_t streamMask;
+};
+
+struct StreamEntry {
+public:
+    uint64_t key;  // e.g. ipv4 address and port of the device
+    uint64_t frames;
+};
+
+struct Footer {
+public:
+    uint64_t indexOffset;
+    uint64_t streamOffset;
+    uint32_t chunkCount;
+    uint32_t streamCount;
+    char magic[8];
+};
+
+static_assert(sizeof(FileHeader) == 24, "FileHeader layout");
+static_assert(sizeof(ChunkHeader) == 40, "ChunkHeader layout");
+static_assert(sizeof(IndexEntry) == 32, "IndexEntry layout");
+static_assert(sizeof(StreamEntry) == 16, "StreamEntry layout");
+static_assert(sizeof(Footer) == 32, "Footer layout");
+
+} // record
+
+#endif // __RECORD_RECORD_FORMAT_H__
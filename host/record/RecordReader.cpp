@@ -0,0 +1,210 @@
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "RecordReader.h"
+
+namespace record {
+
+    bool RecordCursor::next(RecordView& outRecord) {
+        if (stream >= MaxStreams) {
+            return false; // no chunk has it
+        }
+        while (reader != NULL && chunk < reader->index.size()) {
+            const bool hasStream = stream < 0 ||
+                (reader->index[chunk].streamMask & (1ULL << stream)) != 0;
+            ChunkHeader header;
+            if (!hasStream || !reader->readChunkHeader(chunk, header) ||
+                record >= header.recordCount) {
+                chunk++;
+                record = 0;
+                continue;
+            }
+            if (!reader->readRecord(chunk, record, outRecord)) {
+                return false; // broken chunk
+            }
+            record++;
+            if (stream < 0 || outRecord.stream == stream) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    RecordReader::RecordReader() : map(NULL), mapSize(0), wasRecovered(false) { }
+
+    RecordReader::~RecordReader() {
+        close();
+    }
+
+    bool RecordReader::open(const char* path) {
+        close();
+        int fd = ::open(path, O_RDONLY);
+        if (fd < 0) {
+            return false;
+        }
+        struct stat st;
+        if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(FileHeader)) {
+            ::close(fd);
+            return false;
+        }
+        void* mapped = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (mapped == MAP_FAILED) {
+            return false;
+        }
+        map = (const uint8_t*)mapped;
+        mapSize = st.st_size;
+        FileHeader header;
+        memcpy(&header, map, sizeof(FileHeader));
+        if (memcmp(header.magic, FileMagic, sizeof(header.magic)) != 0 ||
+            header.version != FormatVersion) {
+            close();
+            return false;
+        }
+        if (!readFooter() && !recoverIndex()) {
+            close();
+            return false;
+        }
+        return true;
+    }
+
+    void RecordReader::close() {
+        if (map != NULL) {
+            munmap((void*)map, mapSize);
+        }
+        map = NULL;
+        mapSize = 0;
+        index.clear();
+        streams.clear();
+        wasRecovered = false;
+    }
+
+    RecordCursor RecordReader::seek(uint64_t micros, int stream) const {
+        if (stream >= MaxStreams) {
+            return RecordCursor(this, index.size(), 0, stream);
+        }
+        // the first chunk which ends at or after micros
+        size_t lo = 0;
+        size_t hi = index.size();
+        while (lo < hi) {
+            const size_t mid = lo + (hi - lo) / 2;
+            if (index[mid].lastMicros < micros) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+        if (lo == index.size()) {
+            return RecordCursor(this, lo, 0, stream);
+        }
+        // then the first record at or after micros in the chunk
+        ChunkHeader header;
+        uint32_t first = 0;
+        uint32_t last = readChunkHeader(lo, header) ? header.recordCount : 0;
+        RecordView view;
+        while (first < last) {
+            const uint32_t mid = first + (last - first) / 2;
+            if (readRecord(lo, mid, view) && view.micros < micros) {
+                first = mid + 1;
+            } else {
+                last = mid;
+            }
+        }
+        return RecordCursor(this, lo, first, stream);
+    }
+
+    bool RecordReader::readFooter() {
+        if (mapSize < sizeof(FileHeader) + sizeof(Footer)) {
+            return false;
+        }
+        Footer footer;
+        memcpy(&footer, map + mapSize - sizeof(Footer), sizeof(Footer));
+        if (memcmp(footer.magic, FooterMagic, sizeof(footer.magic)) != 0) {
+            return false;
+        }
+        const uint64_t indexBytes = (uint64_t)footer.chunkCount * sizeof(IndexEntry);
+        const uint64_t streamBytes = (uint64_t)footer.streamCount * sizeof(StreamEntry);
+        if (footer.indexOffset + indexBytes > mapSize ||
+            footer.streamOffset + streamBytes > mapSize) {
+            return false;
+        }
+        index.resize(footer.chunkCount);
+        memcpy(index.data(), map + footer.indexOffset, indexBytes);
+        streams.resize(footer.streamCount);
+        memcpy(streams.data(), map + footer.streamOffset, streamBytes);
+        return true;
+    }
+
+    bool RecordReader::recoverIndex() {
+        index.clear();
+        streams.clear();
+        uint64_t offset = sizeof(FileHeader);
+        ChunkHeader header;
+        while (offset + sizeof(ChunkHeader) <= mapSize) {
+            memcpy(&header, map + offset, sizeof(ChunkHeader));
+            const uint64_t chunkEnd = offset + sizeof(ChunkHeader) + header.recordBytes +
+                                      (uint64_t)header.recordCount * sizeof(uint32_t);
+            if (header.magic != ChunkMagic || chunkEnd > mapSize) {
+                break; // the chunk being written
+            }
+            IndexEntry entry;
+            entry.offset = offset;
+            entry.firstMicros = header.firstMicros;
+            entry.lastMicros = header.lastMicros;
+            entry.streamMask = header.streamMask;
+            index.push_back(entry);
+            offset = chunkEnd;
+        }
+        // stream keys are only in the footer, count the frames per stream id
+        RecordCursor cursor(this, 0, 0, -1);
+        RecordView view;
+        while (cursor.next(view)) {
+            while (view.stream >= streams.size()) {
+                StreamEntry entry = { streams.size(), 0 };
+                streams.push_back(entry);
+            }
+            streams[view.stream].frames++;
+        }
+        wasRecovered = true;
+        return true;
+    }
+
+    bool RecordReader::readChunkHeader(size_t chunk, ChunkHeader& outHeader) const {
+        const uint64_t offset = index[chunk].offset;
+        if (offset + sizeof(ChunkHeader) > mapSize) {
+            return false;
+        }
+        // chunks are not aligned in the file
+        memcpy(&outHeader, map + offset, sizeof(ChunkHeader));
+        return outHeader.magic == ChunkMagic &&
+               offset + sizeof(ChunkHeader) + outHeader.recordBytes +
+               (uint64_t)outHeader.recordCount * sizeof(uint32_t) <= mapSize;
+    }
+
+    bool RecordReader::readRecord(size_t chunk, uint32_t record, RecordView& outRecord) const {
+        ChunkHeader header;
+        if (!readChunkHeader(chunk, header) || record >= header.recordCount) {
+            return false;
+        }
+        const uint64_t chunkOffset = index[chunk].offset;
+        const uint64_t table = chunkOffset + sizeof(ChunkHeader) + header.recordBytes;
+        uint32_t recordOffset = 0;
+        memcpy(&recordOffset, map + table + (uint64_t)record * sizeof(uint32_t), sizeof(uint32_t));
+        if (recordOffset < sizeof(ChunkHeader) ||
+            chunkOffset + recordOffset + RecordHeaderLen > table) {
+            return false;
+        }
+        const uint8_t* at = map + chunkOffset + recordOffset;
+        memcpy(&outRecord.micros, at, sizeof(uint64_t));
+        memcpy(&outRecord.stream, at + 8, sizeof(uint16_t));
+        memcpy(&outRecord.length, at + 10, sizeof(uint16_t));
+        if (chunkOffset + recordOffset + RecordHeaderLen + outRecord.length > table) {
+            return false; // the frame runs into the offsets
+        }
+        outRecord.frame = at + RecordHeaderLen;
+        return true;
+    }
+
+} // record
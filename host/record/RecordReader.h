@@ -0,0 +1,66 @@
+#ifndef __RECORD_RECORD_READER_H__
+#define __RECORD_RECORD_READER_H__
+
+#include <inttypes.h>
+#include <stddef.h>
+#include <vector>
+#include "RecordFormat.h"
+
+namespace record {
+
+struct RecordView {
+public:
+    uint64_t micros;
+    uint16_t stream;
+    uint16_t length;
+    const uint8_t* frame;  // session header and payload, points into the map
+};
+
+class RecordReader;
+
+// Walks the records from a position, optionally of one stream only. A stream
+// out of MaxStreams matches no record.
+class RecordCursor {
+public:
+    explicit RecordCursor(const RecordReader* reader, size_t chunk, uint32_t record, int stream)
+        : reader(reader), chunk(chunk), record(record), stream(stream) { }
+    bool next(RecordView& outRecord);
+private:
+    const RecordReader* reader;
+    size_t chunk;
+    uint32_t record;
+    int stream;
+};
+
+// Maps a recording and seeks by time without parsing it. The index is read from
+// the footer, a recording without one (writer killed) is recovered by walking
+// the chunk headers.
+class RecordReader {
+public:
+    explicit RecordReader();
+    ~RecordReader();
+    bool open(const char* path);
+    void close();
+    size_t chunkCount() const { return index.size(); }
+    size_t streamCount() const { return streams.size(); }
+    const StreamEntry& streamEntry(int stream) const { return streams[stream]; }
+    uint64_t firstMicros() const { return index.empty() ? 0 : index.front().firstMicros; }
+    uint64_t lastMicros() const { return index.empty() ? 0 : index.back().lastMicros; }
+    bool recovered() const { return wasRecovered; }
+    RecordCursor seek(uint64_t micros, int stream = -1) const;
+private:
+    friend class RecordCursor;
+    const uint8_t* map;
+    size_t mapSize;
+    std::vector<IndexEntry> index;
+    std::vector<StreamEntry> streams;
+    bool wasRecovered;
+    bool readFooter();
+    bool recoverIndex();
+    bool readChunkHeader(size_t chunk, ChunkHeader& outHeader) const;
+    bool readRecord(size_t chunk, uint32_t record, RecordView& outRecord) const;
+};
+
+} // record
+
+#endif // __RECORD_RECORD_READER_H__
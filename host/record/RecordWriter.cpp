@@ -0,0 +1,131 @@
+#include <string.h>
+#include "RecordWriter.h"
+
+namespace record {
+
+    RecordWriter::RecordWriter(uint32_t chunkBytes)
+        : file(NULL), chunkBytes(chunkBytes), fileOffset(0), lastMicros(0) {
+        memset(&chunkHeader, 0, sizeof(ChunkHeader));
+    }
+
+    RecordWriter::~RecordWriter() {
+        close();
+    }
+
+    bool RecordWriter::open(const char* path, uint64_t createdMicros) {
+        close();
+        file = fopen(path, "wb");
+        if (file == NULL) {
+            return false;
+        }
+        chunk.clear();
+        chunk.reserve(chunkBytes + RecordHeaderLen + UINT16_MAX);
+        offsets.clear();
+        index.clear();
+        streams.clear();
+        fileOffset = 0;
+        lastMicros = 0;
+        FileHeader header;
+        memcpy(header.magic, FileMagic, sizeof(header.magic));
+        header.version = FormatVersion;
+        header.chunkBytes = chunkBytes;
+        header.createdMicros = createdMicros;
+        return writeBytes(&header, sizeof(FileHeader));
+    }
+
+    int RecordWriter::addStream(uint64_t key) {
+        for (size_t i = 0; i < streams.size(); i++) {
+            if (streams[i].key == key) {
+                return (int)i;
+            }
+        }
+        if (streams.size() >= (size_t)MaxStreams) {
+            return -1; // full
+        }
+        StreamEntry entry = { key, 0 };
+        streams.push_back(entry);
+        return (int)streams.size() - 1;
+    }
+
+    bool RecordWriter::write(int stream, uint64_t micros, const uint8_t* frame, uint16_t len) {
+        if (file == NULL || stream < 0 || stream >= (int)streams.size()) {
+            return false;
+        }
+        if (micros < lastMicros) {
+            micros = lastMicros;
+        }
+        lastMicros = micros;
+        if (offsets.empty()) {
+            memset(&chunkHeader, 0, sizeof(ChunkHeader));
+            chunkHeader.magic = ChunkMagic;
+            chunkHeader.firstMicros = micros;
+            chunk.resize(sizeof(ChunkHeader));
+        }
+        offsets.push_back((uint32_t)chunk.size());
+        const uint16_t stream16 = (uint16_t)stream;
+        const size_t at = chunk.size();
+        chunk.resize(at + RecordHeaderLen + len);
+        memcpy(&chunk[at], &micros, sizeof(uint64_t));
+        memcpy(&chunk[at + 8], &stream16, sizeof(uint16_t));
+        memcpy(&chunk[at + 10], &len, sizeof(uint16_t));
+        memcpy(&chunk[at + RecordHeaderLen], frame, len);
+        chunkHeader.recordCount++;
+        chunkHeader.lastMicros = micros;
+        chunkHeader.streamMask |= 1ULL << stream;
+        streams[stream].frames++;
+        if (chunk.size() >= chunkBytes) {
+            return flushChunk();
+        }
+        return true;
+    }
+
+    bool RecordWriter::close() {
+        if (file == NULL) {
+            return false;
+        }
+        bool written = flushChunk();
+        Footer footer;
+        footer.indexOffset = fileOffset;
+        footer.chunkCount = (uint32_t)index.size();
+        written = written && writeBytes(index.data(), sizeof(IndexEntry) * index.size());
+        footer.streamOffset = fileOffset;
+        footer.streamCount = (uint32_t)streams.size();
+        written = written && writeBytes(streams.data(), sizeof(StreamEntry) * streams.size());
+        memcpy(footer.magic, FooterMagic, sizeof(footer.magic));
+        written = written && writeBytes(&footer, sizeof(Footer));
+        written = (fclose(file) == 0) && written;
+        file = NULL;
+        return written;
+    }
+
+    bool RecordWriter::writeBytes(const void* data, size_t len) {
+        if (len == 0) {
+            return true;
+        }
+        if (fwrite(data, 1, len, file) != len) {
+            return false;
+        }
+        fileOffset += len;
+        return true;
+    }
+
+    bool RecordWriter::flushChunk() {
+        if (offsets.empty()) {
+            return true;
+        }
+        chunkHeader.recordBytes = (uint32_t)(chunk.size() - sizeof(ChunkHeader));
+        memcpy(chunk.data(), &chunkHeader, sizeof(ChunkHeader));
+        IndexEntry entry;
+        entry.offset = fileOffset;
+        entry.firstMicros = chunkHeader.firstMicros;
+        entry.lastMicros = chunkHeader.lastMicros;
+        entry.streamMask = chunkHeader.streamMask;
+        index.push_back(entry);
+        const bool written = writeBytes(chunk.data(), chunk.size()) &&
+                             writeBytes(offsets.data(), sizeof(uint32_t) * offsets.size());
+        chunk.clear();
+        offsets.clear();
+        return written;
+    }
+
+} // record
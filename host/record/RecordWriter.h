@@ -0,0 +1,39 @@
+#ifndef __RECORD_RECORD_WRITER_H__
+#define __RECORD_RECORD_WRITER_H__
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <vector>
+#include "RecordFormat.h"
+
+namespace record {
+
+// Streams session frames into a recording. A chunk is buffered in memory and
+// written when it reaches chunkBytes, the index is written by close().
+// micros must not go back, an older one is clamped to the last.
+class RecordWriter {
+public:
+    explicit RecordWriter(uint32_t chunkBytes = DefaultChunkBytes);
+    ~RecordWriter();
+    bool open(const char* path, uint64_t createdMicros);
+    int addStream(uint64_t key);
+    bool write(int stream, uint64_t micros, const uint8_t* frame, uint16_t len);
+    bool close();
+    uint64_t bytesWritten() const { return fileOffset + chunk.size(); }
+private:
+    FILE* file;
+    uint32_t chunkBytes;
+    std::vector<uint8_t> chunk;
+    std::vector<uint32_t> offsets;
+    ChunkHeader chunkHeader;
+    std::vector<IndexEntry> index;
+    std::vector<StreamEntry> streams;
+    uint64_t fileOffset;
+    uint64_t lastMicros;
+    bool writeBytes(const void* data, size_t len);
+    bool flushChunk();
+};
+
+} // record
+
+#endif // __RECORD_RECORD_WRITER_H__
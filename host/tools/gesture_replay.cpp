@@ -0,0 +1,120 @@
+// Replays labeled imu traces through gesture::GestureDetector and compares the
+// detected events with the labels. Fails when any trace has a false positive
+// or a false negative.
+//   g++ -std=c++11 -I src host/tools/gesture_replay.cpp src/gesture/GestureDetector.cpp -o gesture_replay
+//   ./gesture_replay [-t tolerance ms] trace.csv...
+// trace.csv: timestamp[ms],ax,ay,az,gx,gy,gz,qw,qx,qy,qz,label
+// label is the GestureEvent at the sample the gesture happens, 0 otherwise.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include "gesture/GestureDetector.h"
+
+static const char* EventNames[gesture::GestureEventNum] = {
+    "none", "shake", "tap", "flip", "twist"
+};
+
+struct Event {
+    uint32_t timestamp;
+    int event;
+    bool matched;
+};
+
+// returns the false positives + the false negatives, -1 when it cannot be read
+static int replay(const char* path, uint32_t tolerance) {
+    FILE* file = fopen(path, "r");
+    if (file == NULL) {
+        perror(path);
+        return -1;
+    }
+    gesture::GestureDetector detector;
+    std::vector<Event> labels;
+    std::vector<Event> detected;
+    imu::ImuData imuData;
+    gesture::GestureData gesture;
+    char line[512];
+    while (fgets(line, sizeof(line), file) != NULL) {
+        int label = 0;
+        float* a = imuData.acc;
+        float* g = imuData.gyro;
+        float* q = imuData.quat;
+        if (sscanf(line, "%u,%f,%f,%f,%f,%f,%f,%f,%f,%f,%f,%d", &imuData.timestamp,
+                   &a[0], &a[1], &a[2], &g[0], &g[1], &g[2],
+                   &q[0], &q[1], &q[2], &q[3], &label) < 11) {
+            continue; // header or broken line
+        }
+        if (label > 0 && label < gesture::GestureEventNum) {
+            Event e = { imuData.timestamp, label, false };
+            labels.push_back(e);
+        }
+        if (detector.update(imuData, gesture)) {
+            Event e = { gesture.timestamp, gesture.event, false };
+            detected.push_back(e);
+            printf("%10u %-6s %8.2f\n", gesture.timestamp, EventNames[gesture.event], gesture.strength);
+        }
+    }
+    fclose(file);
+
+    // a detection matches the nearest label of the same event within the tolerance
+    int truePositive[gesture::GestureEventNum] = {0};
+    int falsePositive[gesture::GestureEventNum] = {0};
+    int falseNegative[gesture::GestureEventNum] = {0};
+    for (size_t i = 0; i < detected.size(); i++) {
+        Event* best = NULL;
+        for (size_t j = 0; j < labels.size(); j++) {
+            Event& l = labels[j];
+            const uint32_t diff = (l.timestamp > detected[i].timestamp)
+                                      ? l.timestamp - detected[i].timestamp
+                                      : detected[i].timestamp - l.timestamp;
+            if (!l.matched && l.event == detected[i].event && diff <= tolerance) {
+                best = &l;
+                break;
+            }
+        }
+        if (best != NULL) {
+            best->matched = true;
+            truePositive[detected[i].event]++;
+        } else {
+            falsePositive[detected[i].event]++;
+        }
+    }
+    for (size_t j = 0; j < labels.size(); j++) {
+        if (!labels[j].matched) {
+            falseNegative[labels[j].event]++;
+        }
+    }
+    int errors = 0;
+    printf("%s\n%-6s %5s %5s %5s %9s %7s\n", path, "event", "tp", "fp", "fn", "precision", "recall");
+    for (int i = 1; i < gesture::GestureEventNum; i++) {
+        const int tp = truePositive[i];
+        const int fp = falsePositive[i];
+        const int fn = falseNegative[i];
+        printf("%-6s %5d %5d %5d %9.2f %7.2f\n", EventNames[i], tp, fp, fn,
+               (tp + fp) ? (double)tp / (tp + fp) : 1.0,
+               (tp + fn) ? (double)tp / (tp + fn) : 1.0);
+        errors += fp + fn;
+    }
+    return errors;
+}
+
+int main(int argc, char** argv) {
+    uint32_t tolerance = 300;
+    int first = 1;
+    if (argc > 2 && strcmp(argv[1], "-t") == 0) {
+        tolerance = atoi(argv[2]);
+        first = 3;
+    }
+    if (first >= argc) {
+        fprintf(stderr, "usage: %s [-t tolerance ms] trace.csv...\n", argv[0]);
+        return 2;
+    }
+    int failed = 0;
+    for (int i = first; i < argc; i++) {
+        const int errors = replay(argv[i], tolerance);
+        printf("%s: %s\n\n", argv[i], (errors == 0) ? "ok" : "FAILED");
+        failed += (errors == 0) ? 0 : 1;
+    }
+    printf("%d of %d traces failed\n", failed, argc - first);
+    return failed == 0 ? 0 : 1;
+}
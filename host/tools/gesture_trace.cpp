@@ -0,0 +1,191 @@
+// Writes the synthetic labeled imu traces of host/traces for gesture_replay.
+// Each trace moves an ideal device (exact quat, gaussian acc and gyro noise)
+// through still, rotating, shaking and tapping segments at 200[Hz].
+//   g++ -std=c++11 -I src host/tools/gesture_trace.cpp -o gesture_trace
+//   ./gesture_trace host/traces
+#include <stdio.h>
+#include <math.h>
+#include <string>
+#include <random>
+#include "gesture/GestureData.h"
+
+static const float SampleHz = 200.0F;
+static const float AccNoise = 0.02F;  // [g]
+static const float GyroNoise = 0.5F;  // [deg/s]
+static const float Deg = 3.14159265F / 180.0F;
+
+class Trace {
+public:
+    explicit Trace(const std::string& path, const float* quat) : rng(1), noise(0.0F, 1.0F), sample(0) {
+        file = fopen(path.c_str(), "w");
+        if (file != NULL) {
+            fprintf(file, "timestamp,ax,ay,az,gx,gy,gz,qw,qx,qy,qz,label\n");
+        }
+        for (int i = 0; i < 4; i++) {
+            q[i] = quat[i];
+        }
+    }
+    ~Trace() {
+        if (file != NULL) {
+            fclose(file);
+        }
+    }
+    bool isOpen() const { return file != NULL; }
+
+    void still(float seconds) {
+        const float zero[3] = {0.0F, 0.0F, 0.0F};
+        for (int i = 0; i < samples(seconds); i++) {
+            write(zero, zero, 0);
+        }
+    }
+    // about a body axis at a constant rate, labeled at labelAt [s] from the start
+    void rotate(int axis, float degrees, float seconds, int label = 0, float labelAt = 0.0F) {
+        const float zero[3] = {0.0F, 0.0F, 0.0F};
+        float rate[3] = {0.0F, 0.0F, 0.0F};
+        rate[axis] = degrees / seconds;
+        const int n = samples(seconds);
+        const int at = (samples(labelAt) < n) ? samples(labelAt) : n - 1;
+        for (int i = 0; i < n; i++) {
+            write(zero, rate, (label != 0 && i == at) ? label : 0);
+        }
+    }
+    // sine of the world frame linear acc [g] on one axis
+    void oscillate(int axis, float amplitude, float hz, float seconds, int label = 0, float labelAt = 0.0F) {
+        const float zero[3] = {0.0F, 0.0F, 0.0F};
+        const int n = samples(seconds);
+        const int at = (samples(labelAt) < n) ? samples(labelAt) : n - 1;
+        for (int i = 0; i < n; i++) {
+            float linear[3] = {0.0F, 0.0F, 0.0F};
+            linear[axis] = amplitude * sinf(2.0F * 3.14159265F * hz * i / SampleHz);
+            write(linear, zero, (label != 0 && i == at) ? label : 0);
+        }
+    }
+    // a knock of two samples on a world axis
+    void tap(int axis, float amplitude) {
+        const float zero[3] = {0.0F, 0.0F, 0.0F};
+        float linear[3] = {0.0F, 0.0F, 0.0F};
+        linear[axis] = amplitude;
+        write(linear, zero, gesture::GestureTap);
+        write(linear, zero, 0);
+    }
+private:
+    FILE* file;
+    std::mt19937 rng;
+    std::normal_distribution<float> noise;
+    int sample;
+    float q[4];  // w, x, y, z, body to world
+
+    static int samples(float seconds) { return (int)(seconds * SampleHz + 0.5F); }
+
+    void write(const float* linear, const float* rate, int label) {
+        // q = q * exp(rate * dt / 2), rate in the body frame
+        const float half = 0.5F * Deg / SampleHz;
+        const float r[3] = {rate[0] * half, rate[1] * half, rate[2] * half};
+        const float angle = sqrtf(r[0] * r[0] + r[1] * r[1] + r[2] * r[2]);
+        if (angle > 0.0F) {
+            const float s = sinf(angle) / angle;
+            const float d[4] = {cosf(angle), r[0] * s, r[1] * s, r[2] * s};
+            const float p[4] = {q[0], q[1], q[2], q[3]};
+            q[0] = p[0] * d[0] - p[1] * d[1] - p[2] * d[2] - p[3] * d[3];
+            q[1] = p[0] * d[1] + p[1] * d[0] + p[2] * d[3] - p[3] * d[2];
+            q[2] = p[0] * d[2] - p[1] * d[3] + p[2] * d[0] + p[3] * d[1];
+            q[3] = p[0] * d[3] + p[1] * d[2] - p[2] * d[1] + p[3] * d[0];
+        }
+        // the accelerometer reads the world acc + 1[g] up in the body frame
+        const float world[3] = {linear[0], linear[1], linear[2] + 1.0F};
+        const float w = q[0], x = q[1], y = q[2], z = q[3];
+        const float acc[3] = {
+            (1 - 2 * (y * y + z * z)) * world[0] + 2 * (x * y + w * z) * world[1] + 2 * (x * z - w * y) * world[2],
+            2 * (x * y - w * z) * world[0] + (1 - 2 * (x * x + z * z)) * world[1] + 2 * (y * z + w * x) * world[2],
+            2 * (x * z + w * y) * world[0] + 2 * (y * z - w * x) * world[1] + (1 - 2 * (x * x + y * y)) * world[2]
+        };
+        if (file == NULL) {
+            return;
+        }
+        fprintf(file, "%u,%.4f,%.4f,%.4f,%.3f,%.3f,%.3f,%.5f,%.5f,%.5f,%.5f,%d\n",
+                (unsigned)(sample * 1000 / (int)SampleHz),
+                acc[0] + AccNoise * noise(rng), acc[1] + AccNoise * noise(rng), acc[2] + AccNoise * noise(rng),
+                rate[0] + GyroNoise * noise(rng), rate[1] + GyroNoise * noise(rng), rate[2] + GyroNoise * noise(rng),
+                q[0], q[1], q[2], q[3], label);
+        sample++;
+    }
+};
+
+int main(int argc, char** argv) {
+    const std::string dir = (argc > 1) ? argv[1] : ".";
+    const float faceUp[4] = {1.0F, 0.0F, 0.0F, 0.0F};
+    const float upright[4] = {0.70711F, 0.70711F, 0.0F, 0.0F};  // long axis (y) up
+    const int x = 0, y = 1, z = 2;
+    bool ok = true;
+    {
+        Trace trace(dir + "/shake_vertical.csv", faceUp);
+        trace.still(1.0F);
+        trace.oscillate(z, 2.0F, 5.0F, 1.0F, gesture::GestureShake, 0.3F);
+        trace.still(1.5F);
+        trace.oscillate(z, 1.5F, 4.0F, 2.0F, gesture::GestureShake, 0.4F);
+        trace.still(1.0F);
+        ok &= trace.isOpen();
+    }
+    {
+        Trace trace(dir + "/shake_sideways.csv", faceUp);
+        trace.still(1.0F);
+        trace.oscillate(x, 2.5F, 4.0F, 1.0F, gesture::GestureShake, 0.4F);
+        trace.still(1.5F);
+        trace.rotate(x, 30.0F, 1.0F);
+        trace.oscillate(y, 2.0F, 5.0F, 1.5F, gesture::GestureShake, 0.3F);
+        trace.still(1.0F);
+        ok &= trace.isOpen();
+    }
+    {
+        Trace trace(dir + "/tap.csv", faceUp);
+        trace.still(1.0F);
+        trace.tap(z, 2.0F);
+        trace.still(1.0F);
+        trace.tap(z, -1.5F);
+        trace.still(1.0F);
+        trace.tap(x, 2.0F);
+        trace.still(1.0F);
+        ok &= trace.isOpen();
+    }
+    {
+        // flips at about 134[deg] where gravity on z passes -0.7
+        Trace trace(dir + "/flip.csv", faceUp);
+        trace.still(1.0F);
+        trace.rotate(x, 180.0F, 0.5F, gesture::GestureFlip, 0.37F);
+        trace.still(1.5F);
+        trace.rotate(x, -180.0F, 0.8F, gesture::GestureFlip, 0.6F);
+        trace.still(1.0F);
+        ok &= trace.isOpen();
+    }
+    {
+        // held upright so that the twist does not flip the face
+        Trace trace(dir + "/twist.csv", upright);
+        trace.still(1.0F);
+        trace.rotate(y, 180.0F, 0.6F, gesture::GestureTwist, 0.3F);
+        trace.still(1.5F);
+        trace.rotate(y, -90.0F, 0.4F, gesture::GestureTwist, 0.4F);
+        trace.still(1.5F);
+        trace.rotate(y, 220.0F, 1.1F, gesture::GestureTwist, 0.45F);
+        trace.still(1.0F);
+        ok &= trace.isOpen();
+    }
+    {
+        // handled calmly, no gesture
+        Trace trace(dir + "/none.csv", faceUp);
+        trace.still(1.0F);
+        trace.oscillate(z, 0.15F, 2.0F, 2.0F);
+        trace.rotate(z, 90.0F, 2.0F);
+        trace.rotate(y, 60.0F, 2.0F);
+        trace.oscillate(x, 0.2F, 1.5F, 2.0F);
+        trace.rotate(y, -60.0F, 2.0F);
+        trace.rotate(x, 40.0F, 1.0F);
+        trace.rotate(x, -40.0F, 1.0F);
+        trace.still(1.0F);
+        ok &= trace.isOpen();
+    }
+    if (!ok) {
+        perror(dir.c_str());
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,110 @@
+// Runs imu::LinearMotion over synthetic trajectories and prints the error of the
+// linear acc and the velocity against the ground truth. Fails when a
+// trajectory is off by more than its bounds, which hold at the default noise.
+//   g++ -std=c++11 -O2 -I src host/tools/motion_sim.cpp src/imu/LinearMotion.cpp -o motion_sim
+//   ./motion_sim [acc noise g] [tilt error deg]
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <random>
+#include "imu/LinearMotion.h"
+
+static const float Gravity = 9.80665F;
+static const float SampleHz = 200.0F;
+static const float DegToRad = 0.017453292F;
+
+struct Trajectory {
+    const char* name;
+    float accX;     // [m/s^2] world x, +accX then -accX
+    float pushTime; // [s] of each half
+    float yawRate;  // [deg/s] while pushing
+    float tilt;     // [deg] around x
+    float maxAccRms;  // [m/s^2]
+    float maxVel;     // [m/s] error at any time
+};
+
+static const float MaxVelEnd = 0.01F;  // [m/s] after the device stays still
+
+// q = yaw(z) * tilt(x)
+static void makeQuat(float yaw, float tilt, float* q) {
+    const float cy = cosf(yaw * 0.5F), sy = sinf(yaw * 0.5F);
+    const float cx = cosf(tilt * 0.5F), sx = sinf(tilt * 0.5F);
+    q[0] = cy * cx;
+    q[1] = cy * sx;
+    q[2] = sy * sx;
+    q[3] = sy * cx;
+}
+
+// world to body, transpose of the rotation by q
+static void toBody(const float* q, const float* w, float* b) {
+    const float q0 = q[0], q1 = q[1], q2 = q[2], q3 = q[3];
+    b[0] = (1 - 2 * (q2 * q2 + q3 * q3)) * w[0] + 2 * (q1 * q2 + q0 * q3) * w[1] + 2 * (q1 * q3 - q0 * q2) * w[2];
+    b[1] = 2 * (q1 * q2 - q0 * q3) * w[0] + (1 - 2 * (q1 * q1 + q3 * q3)) * w[1] + 2 * (q2 * q3 + q0 * q1) * w[2];
+    b[2] = 2 * (q1 * q3 + q0 * q2) * w[0] + 2 * (q2 * q3 - q0 * q1) * w[1] + (1 - 2 * (q1 * q1 + q2 * q2)) * w[2];
+}
+
+int main(int argc, char** argv) {
+    const float accNoise = (argc > 1) ? atof(argv[1]) : 0.005F;
+    const float tiltError = ((argc > 2) ? atof(argv[2]) : 0.5F) * DegToRad;
+    const Trajectory trajectories[] = {
+        { "still",      0.0F, 0.5F,  0.0F,  0.0F, 0.04F, 0.02F },
+        { "still tilt", 0.0F, 0.5F,  0.0F, 35.0F, 0.04F, 0.02F },
+        { "push",       2.0F, 0.5F,  0.0F,  0.0F, 0.10F, 0.02F },
+        { "push tilt",  2.0F, 0.5F,  0.0F, 35.0F, 0.10F, 0.02F },
+        // the gyro sees the yaw on the body z only approximately
+        { "push yaw",   2.0F, 0.5F, 90.0F, 20.0F, 0.15F, 0.15F },
+    };
+    std::mt19937 rng(1);
+    std::normal_distribution<float> noise(0.0F, 1.0F);
+    int failed = 0;
+    printf("%-10s %10s %10s %10s %10s\n", "trajectory", "acc rms", "vel rms", "vel max", "vel end");
+    for (const Trajectory& t : trajectories) {
+        imu::LinearMotion motion;
+        imu::ImuData imuData;
+        imu::ImuMotionData out;
+        const int still = (int)(1.0F * SampleHz);
+        const int push = (int)(t.pushTime * SampleHz);
+        const int total = still + push * 2 + still;
+        float velocity = 0.0F, yaw = 0.0F;
+        double accSq = 0.0, velSq = 0.0, velMax = 0.0;
+        for (int i = 0; i < total; i++) {
+            float accX = 0.0F, yawRate = 0.0F;
+            if (i >= still && i < still + push) {
+                accX = t.accX;
+                yawRate = t.yawRate;
+            } else if (i >= still + push && i < still + push * 2) {
+                accX = -t.accX;
+                yawRate = t.yawRate;
+            }
+            velocity += accX / SampleHz;
+            yaw += yawRate * DegToRad / SampleHz;
+
+            float q[4], world[3] = { accX / Gravity, 0.0F, 1.0F }, body[3];
+            makeQuat(yaw, t.tilt * DegToRad, q);
+            toBody(q, world, body);
+            // the fused attitude is off by tiltError
+            makeQuat(yaw, t.tilt * DegToRad + tiltError, imuData.quat);
+            for (int j = 0; j < 3; j++) {
+                imuData.acc[j] = body[j] + accNoise * noise(rng);
+                imuData.gyro[j] = 0.3F * noise(rng);
+            }
+            // rotation seen by the gyro on the body z, approximately
+            imuData.gyro[2] += yawRate;
+            imuData.timestamp = (uint32_t)(i * 1000 / SampleHz);
+            motion.update(imuData, out);
+
+            const float accError = out.linearAcc[0] - accX;
+            const float velError = out.velocity[0] - velocity;
+            accSq += accError * accError + out.linearAcc[1] * out.linearAcc[1];
+            velSq += velError * velError + out.velocity[1] * out.velocity[1];
+            velMax = fmax(velMax, sqrt(velError * velError + out.velocity[1] * out.velocity[1]));
+        }
+        const double accRms = sqrt(accSq / total);
+        const bool ok = accRms <= t.maxAccRms && velMax <= t.maxVel &&
+                        fabs(out.velocity[0]) <= MaxVelEnd && fabs(out.velocity[1]) <= MaxVelEnd;
+        printf("%-10s %8.3fm/s2 %7.3fm/s %7.3fm/s %7.3fm/s %s\n", t.name, accRms,
+               sqrt(velSq / total), velMax, out.velocity[0], ok ? "ok" : "FAILED");
+        failed += ok ? 0 : 1;
+    }
+    return failed == 0 ? 0 : 1;
+}
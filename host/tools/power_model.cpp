@@ -0,0 +1,30 @@
+// Estimates the duty cycle and the battery life of each power profile.
+//   g++ -std=c++11 -I src -I host host/tools/power_model.cpp host/power/DutyCycleModel.cpp -o power_model
+//   ./power_model [sample Hz] [batch size]
+#include <stdio.h>
+#include <stdlib.h>
+#include "power/DutyCycleModel.h"
+
+int main(int argc, char** argv) {
+    const double sampleHz = (argc > 1) ? atof(argv[1]) : 200.0;
+    const int batchSize = (argc > 2) ? atoi(argv[2]) : 0;
+    power::PowerModel model;
+
+    printf("%-9s %5s %5s %7s %7s %7s %7s %7s %7s %7s %8s %7s\n", "profile", "MHz",
+           "batch", "pkt/s", "wake/s", "cpu", "idle", "sleep", "tx", "rx", "mA", "hours");
+    for (int i = 0; i < power::PowerProfileNum; i++) {
+        power::PowerSetting setting = power::PowerSettings[i];
+        if (batchSize > 0) {
+            // send once per batch
+            setting.batchSize = batchSize;
+            setting.sendInterval = (uint16_t)(batchSize * 1000.0 / sampleHz);
+        }
+        power::DutyCycle duty = power::estimateDutyCycle(setting, sampleHz, model);
+        printf("%-9s %5u %5u %7.1f %7.1f %6.1f%% %6.1f%% %6.1f%% %6.1f%% %6.1f%% %8.1f %7.2f\n",
+               setting.name, setting.cpuMhz, setting.batchSize, duty.packetsPerSecond,
+               duty.wakeUpsPerSecond, duty.cpuActive * 100.0, duty.cpuIdle * 100.0, duty.cpuSleep * 100.0,
+               duty.radioTx * 100.0, duty.radioRx * 100.0, duty.milliamps,
+               duty.batteryHours);
+    }
+    return 0;
+}
@@ -0,0 +1,148 @@
+// Receives Ryap session frames on the host, prints the telemetry frames,
+// answers the time sync requests with CLOCK_MONOTONIC [us] and optionally
+// records every frame.
+//   g++ -std=c++11 -I src -I host host/tools/ryap_monitor.cpp host/record/RecordWriter.cpp -o ryap_monitor
+//   ./ryap_monitor [port] [device port] [record file]
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "session/SessionDefine.h"
+#include "profile/TelemetryData.h"
+#include "timesync/TimeSyncData.h"
+#include "record/RecordWriter.h"
+
+static volatile sig_atomic_t stopRequested = 0;
+
+static void onStop(int) {
+    stopRequested = 1;
+}
+
+static const char* SectionNames[profile::TelemetrySectionNum] = {
+    "imu update", "imu mutex wait", "session imu wait", "udp endPacket",
+    "session btn wait", "linear motion", "gesture"
+};
+static const char* TaskNames[profile::TelemetryTaskNum] = {
+    "imu", "write", "button", "read"
+};
+
+static uint64_t monotonicMicros() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000;
+}
+
+static void answerTimeSync(int sock, sockaddr_in peer, int devicePort,
+                           const uint8_t* payload, uint64_t receivedAt) {
+    uint8_t buf[session::data_length::header + session::data_length::timeSyncResponse];
+    timesync::TimeSyncData data;
+    memcpy(&data, payload, timesync::TimeSyncDataLen);
+    data.receive = receivedAt;
+    const uint16_t dataType = session::data_type::timeSyncResponse;
+    const uint16_t dataLength = session::data_length::timeSyncResponse;
+    memcpy(buf, &dataType, sizeof(uint16_t));
+    memcpy(buf + sizeof(uint16_t), &dataLength, sizeof(uint16_t));
+    peer.sin_port = htons(devicePort);
+    data.transmit = monotonicMicros();
+    memcpy(buf + session::data_length::header, &data, timesync::TimeSyncDataLen);
+    sendto(sock, buf, sizeof(buf), 0, (sockaddr*)&peer, sizeof(peer));
+}
+
+static void printTelemetry(const char* from, const profile::TelemetryData& t) {
+    if (t.section >= profile::TelemetrySectionNum) {
+        return;
+    }
+    if (t.cpuMhz != 0) {
+        const double cyclesPerUs = t.cpuMhz;
+        const double meanUs = (t.count != 0) ? t.sumCycles / cyclesPerUs / t.count : 0.0;
+        printf("[%s %10u ms] %-18s n=%5u mean=%9.1fus max=%9.1fus |",
+               from, t.timestamp, SectionNames[t.section], t.count, meanUs,
+               t.maxCycles / cyclesPerUs);
+    } else {
+        // the clock is scaled, only the cycles are known
+        const double mean = (t.count != 0) ? (double)t.sumCycles / t.count : 0.0;
+        printf("[%s %10u ms] %-18s n=%5u mean=%9.0fcy max=%9ucy |",
+               from, t.timestamp, SectionNames[t.section], t.count, mean, t.maxCycles);
+    }
+    for (int i = 0; i < profile::TelemetryBucketNum; i++) {
+        printf(" %u", t.buckets[i]);
+    }
+    printf("\n");
+    if (t.section == 0) {
+        printf("[%s %10u ms] heap free=%u min=%u stack free:", from,
+               t.timestamp, t.freeHeap, t.minFreeHeap);
+        for (int i = 0; i < profile::TelemetryTaskNum; i++) {
+            printf(" %s=%u", TaskNames[i], t.stackHighWater[i]);
+        }
+        printf("\n");
+    }
+}
+
+int main(int argc, char** argv) {
+    int port = (argc > 1) ? atoi(argv[1]) : 22222;
+    int devicePort = (argc > 2) ? atoi(argv[2]) : 22223;
+    const char* recordPath = (argc > 3) ? argv[3] : NULL;
+    record::RecordWriter writer;
+    if (recordPath != NULL && !writer.open(recordPath, monotonicMicros())) {
+        perror(recordPath);
+        return 1;
+    }
+    // no SA_RESTART, recvfrom returns on the signal
+    struct sigaction stop = {};
+    stop.sa_handler = onStop;
+    sigaction(SIGINT, &stop, NULL);
+    sigaction(SIGTERM, &stop, NULL);
+    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    if (sock < 0) {
+        perror("socket");
+        return 1;
+    }
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons(port);
+    if (bind(sock, (sockaddr*)&addr, sizeof(addr)) != 0) {
+        perror("bind");
+        return 1;
+    }
+    uint8_t buf[session::data_length::header + session::data_length::max];
+    while (!stopRequested) {
+        sockaddr_in peer = {};
+        socklen_t peerLen = sizeof(peer);
+        ssize_t len = recvfrom(sock, buf, sizeof(buf), 0, (sockaddr*)&peer, &peerLen);
+        uint64_t receivedAt = monotonicMicros();
+        if (len < session::data_length::header) {
+            continue;
+        }
+        uint16_t dataType = buf[0] | (buf[1] << 8);
+        uint16_t dataLength = buf[2] | (buf[3] << 8);
+        if (len < session::data_length::header + dataLength) {
+            continue;
+        }
+        if (recordPath != NULL) {
+            const uint64_t key = ((uint64_t)ntohl(peer.sin_addr.s_addr) << 16) | ntohs(peer.sin_port);
+            writer.write(writer.addStream(key), receivedAt, buf,
+                         session::data_length::header + dataLength);
+        }
+        if (dataType == session::data_type::telemetry &&
+            dataLength == session::data_length::telemetry) {
+            profile::TelemetryData telemetry;
+            memcpy(&telemetry, buf + session::data_length::header,
+                   profile::TelemetryDataLen);
+            printTelemetry(inet_ntoa(peer.sin_addr), telemetry);
+        } else if (dataType == session::data_type::timeSyncRequest &&
+                   dataLength == session::data_length::timeSyncRequest) {
+            answerTimeSync(sock, peer, devicePort,
+                           buf + session::data_length::header, receivedAt);
+        }
+    }
+    close(sock);
+    if (recordPath != NULL) {
+        writer.close();
+    }
+    return 0;
+}
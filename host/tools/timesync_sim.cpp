@@ -0,0 +1,153 @@
+// Runs timesync::ClockSync against a simulated device clock with skew and
+// random network delay, and prints the error of the shared timestamps.
+// The device polls for the response, so its receive time is late by up to
+// PollLatency, and some responses come back only after the next request.
+// Fails when the steady state error is not sub millisecond, the drift is off
+// the simulated skew by more than MaxDriftError or a late response is taken.
+// "profiles" runs every power::PowerSettings at its timeSyncInterval with a
+// downlink slower than the uplink. The radio is held awake for the exchange,
+// the same profile with the radio left in power save (the access point holds
+// the response until the next wake up) is printed but not checked.
+//   g++ -std=c++11 -I src host/tools/timesync_sim.cpp src/timesync/ClockSync.cpp -o timesync_sim
+//   ./timesync_sim [skew ppm] [mean delay us] [seconds] [interval ms]
+//   ./timesync_sim profiles
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <random>
+#include "power/PowerProfile.h"
+#include "timesync/ClockSync.h"
+
+// steady state once the drift history is full
+static const int SettleExchanges = timesync::SyncSampleNum * timesync::SyncAnchorNum;
+static const double MaxError = 1000.0;     // [us]
+static const double MaxDriftError = 15.0;  // [ppm]
+static const double PollLatency = 100.0;   // [us] other tasks run first
+static const double LateRate = 0.05;
+static const double BeaconInterval = 102400.0;  // [us]
+static const double ProfileSkew = 40.0;         // [ppm]
+static const double ProfileUpDelay = 2000.0;    // [us] mean
+static const double ProfileDownDelay = 4000.0;  // [us] mean
+
+struct Scenario {
+public:
+    double skewPpm;
+    double upDelay;    // [us] mean queueing
+    double downDelay;  // [us] mean queueing
+    int seconds;
+    double interval;   // [us]
+    double wakeUp;     // [us] the response waits up to this for the radio, 0: awake
+    bool verbose;
+};
+
+static bool run(const Scenario& scenario) {
+    const double deviceStart = 123456789.0;  // [us] device clock at host 0
+    const double skewPpm = scenario.skewPpm;
+    std::mt19937 rng(1);
+    std::exponential_distribution<double> upQueueing(1.0 / scenario.upDelay);
+    std::exponential_distribution<double> downQueueing(1.0 / scenario.downDelay);
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+    auto deviceClock = [&](double host) {
+        return (uint64_t)(deviceStart + host * (1.0 + skewPpm * 1e-6));
+    };
+
+    timesync::ClockSync sync;
+    double host = 1000000.0;
+    const double interval = scenario.interval;
+    const int exchanges = (int)(scenario.seconds * 1000000.0 / interval);
+    int syncedAt = -1;
+    double maxError = 0.0;
+    double maxDriftError = 0.0;
+    int checked = 0;
+    int lateTaken = 0;
+    timesync::TimeSyncData late;
+    bool hasLate = false;
+    for (int s = 0; s < exchanges; s++, host += interval) {
+        timesync::TimeSyncData data;
+        data.sequence = s;
+        data.originate = deviceClock(host);
+        sync.requestSent(data);
+        const double up = 300.0 + upQueueing(rng);
+        const double down = 300.0 + downQueueing(rng) + scenario.wakeUp * uniform(rng);
+        data.receive = (uint64_t)(host + up);
+        data.transmit = (uint64_t)(host + up + 50.0);
+        if (hasLate) {
+            // the response to the previous request arrives now
+            lateTaken += sync.update(late, deviceClock(host + 100.0)) ? 1 : 0;
+            hasLate = false;
+        }
+        if (uniform(rng) < LateRate) {
+            late = data;
+            hasLate = true;
+        } else {
+            const double poll = PollLatency * uniform(rng);
+            sync.update(data, deviceClock(host + up + 50.0 + down + poll));
+        }
+        if (!sync.isSynced()) {
+            if (scenario.verbose) {
+                printf("%3d rtt=%6u not synced\n", s, sync.roundTrip());
+            }
+            continue;
+        }
+        if (syncedAt < 0) {
+            syncedAt = s;
+        }
+
+        // error right before the next exchange, the worst case for drift
+        const double probe = host + interval - 1000.0;
+        const double error = (double)(int64_t)(sync.toShared(deviceClock(probe)) - (uint64_t)probe);
+        // drift is the slope of receiver - device against the device clock
+        const double driftError = sync.drift() * 1e6 + skewPpm / (1.0 + skewPpm * 1e-6);
+        if (scenario.verbose) {
+            printf("%3d offset=%12lld rtt=%6u drift=%8.2fppm error=%8.1fus\n", s,
+                   (long long)sync.offset(), sync.roundTrip(), sync.drift() * 1e6, error);
+        }
+        if (s >= SettleExchanges) {
+            maxError = fmax(maxError, fabs(error));
+            maxDriftError = fmax(maxDriftError, fabs(driftError));
+            checked++;
+        }
+    }
+
+    const bool ok = checked > 0 && lateTaken == 0 && maxError < MaxError && maxDriftError <= MaxDriftError;
+    printf("synced at %d, %d late taken, %d in steady state, max error=%.1fus max drift error=%.2fppm: %s\n",
+           syncedAt, lateTaken, checked, maxError, maxDriftError, ok ? "ok" : "FAILED");
+    return ok;
+}
+
+int main(int argc, char** argv) {
+    if (argc > 1 && strcmp(argv[1], "profiles") == 0) {
+        bool ok = true;
+        for (int i = 0; i < power::PowerProfileNum; i++) {
+            const power::PowerSetting& setting = power::PowerSettings[i];
+            Scenario scenario;
+            scenario.skewPpm = ProfileSkew;
+            scenario.upDelay = ProfileUpDelay;
+            scenario.downDelay = ProfileDownDelay;
+            scenario.interval = setting.timeSyncInterval * 1000.0;
+            scenario.seconds = (int)((SettleExchanges + 64) * setting.timeSyncInterval / 1000);
+            scenario.wakeUp = 0.0;
+            scenario.verbose = false;
+            printf("%-8s radio awake: ", setting.name);
+            ok &= run(scenario);
+            if (setting.powerSave != power::PowerSaveNone) {
+                const int beacons = (setting.powerSave == power::PowerSaveMaxModem && setting.listenInterval > 0)
+                                        ? setting.listenInterval : 1;
+                scenario.wakeUp = BeaconInterval * beacons;
+                printf("%-8s power save, not checked: ", setting.name);
+                run(scenario);
+            }
+        }
+        return ok ? 0 : 1;
+    }
+    Scenario scenario;
+    scenario.skewPpm = (argc > 1) ? atof(argv[1]) : 40.0;
+    scenario.upDelay = (argc > 2) ? atof(argv[2]) : 2000.0;
+    scenario.downDelay = scenario.upDelay;
+    scenario.seconds = (argc > 3) ? atoi(argv[3]) : 120;
+    scenario.interval = ((argc > 4) ? atof(argv[4]) : 250.0) * 1000.0;
+    scenario.wakeUp = 0.0;
+    scenario.verbose = true;
+    return run(scenario) ? 0 : 1;
+}
@@ -0,0 +1,31 @@
+#ifndef __GESTURE_GESTURE_DATA_H__
+#define __GESTURE_GESTURE_DATA_H__
+
+#include <inttypes.h>
+
+namespace gesture {
+
+enum GestureEvent {
+    GestureNone = 0,
+    GestureShake = 1,
+    GestureTap = 2,
+    GestureFlip = 3,
+    GestureTwist = 4
+};
+
+static const int GestureEventNum = 5;
+static const int GestureDataLen = 12;//4 + 2 + 2 + 4;
+
+struct GestureData {
+public:
+    uint32_t timestamp;
+    uint16_t event;
+    uint16_t reserved;
+    float strength;  // shake: std [g] of the most shaken axis, tap: jerk [g/s], flip: +1 face up / -1 face down, twist: angle [deg]
+
+    explicit GestureData() : timestamp(0), event(GestureNone), reserved(0), strength(0.0F) { }
+};
+
+} // gesture
+
+#endif // __GESTURE_GESTURE_DATA_H__
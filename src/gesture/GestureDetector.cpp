@@ -0,0 +1,160 @@
+#include <math.h>
+#include <string.h>
+#include "GestureDetector.h"
+
+namespace gesture {
+
+    GestureDetector::GestureDetector(const GestureConfig& config) : config(config) {
+        reset();
+    }
+
+    void GestureDetector::reset() {
+        memset(acc, 0, sizeof(float) * GestureWindowLen * imu::ImuXyz);
+        memset(twistRate, 0, sizeof(float) * GestureWindowLen);
+        memset(crossing, 0, sizeof(uint8_t) * GestureWindowLen);
+        memset(sumAcc, 0, sizeof(float) * imu::ImuXyz);
+        memset(sumAccSq, 0, sizeof(float) * imu::ImuXyz);
+        memset(crossings, 0, sizeof(int) * imu::ImuXyz);
+        memset(crossingSide, 0, sizeof(int8_t) * imu::ImuXyz);
+        memset(lastAcc, 0, sizeof(float) * imu::ImuXyz);
+        memset(holdOffLeft, 0, sizeof(uint16_t) * GestureEventNum);
+        head = 0;
+        count = 0;
+        sumTwist = 0.0F;
+        face = 0;
+        shaking = false;
+        twisting = false;
+        holdOffSamples = (uint16_t)(config.holdOff * config.sampleHz);
+    }
+
+    bool GestureDetector::update(const imu::ImuData& imuData, GestureData& outGesture) {
+        const float* q = imuData.quat;
+        const float rate = imuData.gyro[config.twistAxis];
+
+        // slide the window
+        if (count == GestureWindowLen) {
+            for (int i = 0; i < imu::ImuXyz; i++) {
+                sumAcc[i] -= acc[head][i];
+                sumAccSq[i] -= acc[head][i] * acc[head][i];
+                crossings[i] -= (crossing[head] >> i) & 1;
+            }
+            sumTwist -= twistRate[head];
+        } else {
+            count++;
+        }
+        uint8_t crossed = 0;
+        float jerkSq = 0.0F;
+        for (int i = 0; i < imu::ImuXyz; i++) {
+            const float value = imuData.acc[i];
+            acc[head][i] = value;
+            sumAcc[i] += value;
+            sumAccSq[i] += value * value;
+            // around the mean, gravity does not count
+            const float diff = value - sumAcc[i] / count;
+            if (diff > config.crossingBand) {
+                crossed |= (crossingSide[i] < 0) ? (1 << i) : 0;
+                crossingSide[i] = 1;
+            } else if (diff < -config.crossingBand) {
+                crossed |= (crossingSide[i] > 0) ? (1 << i) : 0;
+                crossingSide[i] = -1;
+            }
+            crossings[i] += (crossed >> i) & 1;
+            const float step = (count > 1) ? value - lastAcc[i] : 0.0F;
+            jerkSq += step * step;
+            lastAcc[i] = value;
+        }
+        twistRate[head] = rate;
+        crossing[head] = crossed;
+        sumTwist += rate;
+        head = (head + 1) % GestureWindowLen;
+        if (head == 0) {
+            // sum again once a window to drop the rounding error
+            sumTwist = 0.0F;
+            for (int i = 0; i < imu::ImuXyz; i++) {
+                sumAcc[i] = sumAccSq[i] = 0.0F;
+                for (int j = 0; j < count; j++) {
+                    sumAcc[i] += acc[j][i];
+                    sumAccSq[i] += acc[j][i] * acc[j][i];
+                }
+            }
+            for (int j = 0; j < count; j++) {
+                sumTwist += twistRate[j];
+            }
+        }
+        const float jerk = sqrtf(jerkSq) * config.sampleHz;
+        for (int i = 0; i < GestureEventNum; i++) {
+            if (holdOffLeft[i] > 0) {
+                holdOffLeft[i]--;
+            }
+        }
+
+        // flip, gravity on z of the device
+        const float gravityZ = q[0] * q[0] - q[1] * q[1] - q[2] * q[2] + q[3] * q[3];
+        int8_t newFace = face;
+        if (gravityZ > config.flipGravity) {
+            newFace = 1;
+        } else if (gravityZ < -config.flipGravity) {
+            newFace = -1;
+        }
+        if (newFace != face) {
+            const bool flipped = (face != 0);
+            face = newFace;
+            if (flipped && emit(GestureFlip, face, imuData.timestamp, outGesture)) {
+                return true;
+            }
+        }
+
+        // the most shaken axis
+        int axis = 0;
+        float variance = -1.0F;
+        int maxCrossings = 0;
+        for (int i = 0; i < imu::ImuXyz; i++) {
+            const float mean = sumAcc[i] / count;
+            const float v = sumAccSq[i] / count - mean * mean;
+            if (v > variance) {
+                variance = v;
+                axis = i;
+            }
+            maxCrossings = (crossings[i] > maxCrossings) ? crossings[i] : maxCrossings;
+        }
+        const float std = (variance > 0.0F) ? sqrtf(variance) : 0.0F;
+        const float angle = sumTwist / config.sampleHz;
+        if (shaking && (crossings[axis] < config.shakeCrossings / 2 || std < config.shakeStd / 2)) {
+            shaking = false;
+        }
+        if (twisting && fabsf(angle) < config.twistAngle / 2) {
+            twisting = false;
+        }
+
+        // decision tree
+        if (crossings[axis] >= config.shakeCrossings) {
+            if (!shaking && std >= config.shakeStd &&
+                emit(GestureShake, std, imuData.timestamp, outGesture)) {
+                shaking = true;
+                return true;
+            }
+            return false;
+        }
+        if (jerk >= config.tapJerk && maxCrossings <= config.tapMaxCrossings) {
+            return emit(GestureTap, jerk, imuData.timestamp, outGesture);
+        }
+        if (!twisting && fabsf(angle) >= config.twistAngle &&
+            emit(GestureTwist, angle, imuData.timestamp, outGesture)) {
+            twisting = true;
+            return true;
+        }
+        return false;
+    }
+
+    bool GestureDetector::emit(GestureEvent event, float strength, uint32_t timestamp, GestureData& outGesture) {
+        if ((config.enabled & (1 << event)) == 0 || holdOffLeft[event] > 0) {
+            return false;
+        }
+        holdOffLeft[event] = holdOffSamples;
+        outGesture.timestamp = timestamp;
+        outGesture.event = event;
+        outGesture.strength = strength;
+        return true;
+    }
+
+} // gesture
@@ -0,0 +1,61 @@
+#ifndef __GESTURE_GESTURE_DETECTOR_H__
+#define __GESTURE_GESTURE_DETECTOR_H__
+
+#include <inttypes.h>
+#include "../imu/ImuData.h"
+#include "GestureData.h"
+
+namespace gesture {
+
+static const int GestureWindowLen = 100;  // 0.5[s] at 200[Hz]
+
+struct GestureConfig {
+public:
+    float sampleHz = 200.0F;
+    uint8_t enabled = 0x1E;               // bit n: GestureEvent n
+    float shakeStd = 0.6F;                // [g] of the most shaken axis
+    int shakeCrossings = 4;               // of the axis mean in the window
+    float crossingBand = 0.3F;            // [g]
+    float tapJerk = 120.0F;               // [g/s]
+    int tapMaxCrossings = 2;
+    float flipGravity = 0.7F;             // gravity on z to decide the face
+    int twistAxis = 1;                    // long axis of the M5StickC
+    float twistAngle = 90.0F;             // [deg] in the window
+    float holdOff = 0.5F;                 // [s] between the same events, >= the window
+};
+
+// Streaming features over a fixed window of acc and the twist axis gyro,
+// updated in O(1) per sample, and a small decision tree over them. The mean
+// of each acc axis over the window is the gravity, the crossings are counted
+// around it so a shake in any direction is seen. A shake or a twist is
+// reported once, then again after it falls under half its threshold.
+// Call once per ImuReader::update().
+class GestureDetector {
+public:
+    explicit GestureDetector(const GestureConfig& config = GestureConfig());
+    void reset();
+    bool update(const imu::ImuData& imuData, GestureData& outGesture);
+private:
+    GestureConfig config;
+    float acc[GestureWindowLen][imu::ImuXyz];
+    float twistRate[GestureWindowLen];
+    uint8_t crossing[GestureWindowLen];  // bit n: axis n crossed its mean
+    int head;
+    int count;
+    float sumAcc[imu::ImuXyz];
+    float sumAccSq[imu::ImuXyz];
+    float sumTwist;
+    int crossings[imu::ImuXyz];
+    int8_t crossingSide[imu::ImuXyz];
+    int8_t face;
+    float lastAcc[imu::ImuXyz];
+    bool shaking;
+    bool twisting;
+    uint16_t holdOffSamples;
+    uint16_t holdOffLeft[GestureEventNum];
+    bool emit(GestureEvent event, float strength, uint32_t timestamp, GestureData& outGesture);
+};
+
+} // gesture
+
+#endif // __GESTURE_GESTURE_DETECTOR_H__
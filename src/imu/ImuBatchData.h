@@ -0,0 +1,51 @@
+#ifndef __IMU_IMU_BATCH_DATA_H__
+#define __IMU_IMU_BATCH_DATA_H__
+
+#include <inttypes.h>
+#include <string.h>
+#include "ImuData.h"
+
+namespace imu {
+
+static const int ImuBatchMax = 16;  // twice the largest batchSize, the sender may lag
+static const int ImuBatchHeaderLen = 12;//8 + 1 + 1 + 2;
+static const int ImuBatchSampleLen = 48;//4 + 44;
+static const uint8_t ImuBatchFlagShared = 0x01;  // micros in the receiver clock
+
+struct ImuBatchSample {
+public:
+    uint32_t deltaMicros;  // [us] from the first sample
+    ImuData imu;
+};
+
+struct ImuBatchData {
+public:
+    uint64_t micros;  // [us] first sample, device clock unless ImuBatchFlagShared
+    uint8_t count;
+    uint8_t flags;
+    uint16_t reserved;
+    ImuBatchSample samples[ImuBatchMax];
+
+    explicit ImuBatchData() : micros(0), count(0), flags(0), reserved(0) { }
+    bool push(const ImuData& imuData, uint64_t localMicros) {
+        if (count >= ImuBatchMax) {
+            return false;
+        }
+        if (count == 0) {
+            micros = localMicros;
+        }
+        samples[count].deltaMicros = (uint32_t)(localMicros - micros);
+        samples[count].imu = imuData;
+        count++;
+        return true;
+    }
+    void clear() {
+        count = 0;
+        flags = 0;
+    }
+    uint16_t length() const { return ImuBatchHeaderLen + ImuBatchSampleLen * count; }
+};
+
+} // imu
+
+#endif // __IMU_IMU_BATCH_DATA_H__
@@ -2,7 +2,7 @@
 #define __IMU_IMU_DATA_H__
 
 #include <inttypes.h>
-#include <Arduino.h>
+#include <string.h>
 
 namespace imu {
 
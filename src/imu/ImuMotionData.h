@@ -0,0 +1,30 @@
+#ifndef __IMU_IMU_MOTION_DATA_H__
+#define __IMU_IMU_MOTION_DATA_H__
+
+#include <inttypes.h>
+#include <string.h>
+#include "ImuData.h"
+
+namespace imu {
+
+static const int ImuMotionDataLen = 80;//8 + 44 + (4*3) + (4*3) + 4;
+static const uint32_t MotionFlagStationary = 0x01;
+static const uint32_t MotionFlagShared = 0x02;  // micros in the receiver clock
+
+struct ImuMotionData {
+public:
+    uint64_t micros;          // [us] device clock unless MotionFlagShared
+    ImuData imu;
+    float linearAcc[ImuXyz];  // [m/s^2] world frame, gravity removed
+    float velocity[ImuXyz];   // [m/s] world frame
+    uint32_t flags;
+
+    explicit ImuMotionData() : micros(0), imu(), flags(0) {
+        memset(linearAcc, 0, sizeof(float) * ImuXyz);
+        memset(velocity, 0, sizeof(float) * ImuXyz);
+    }
+};
+
+} // imu
+
+#endif // __IMU_IMU_MOTION_DATA_H__
@@ -1,7 +1,10 @@
+#include <esp_timer.h>
 #include "ImuReader.h"
 
 namespace imu {
-    ImuReader::ImuReader(IMU& m5) : m5Imu(m5), ahrs(), imuData() {
+    ImuReader::ImuReader(IMU& m5, bool timestampAtRead)
+        : m5Imu(m5), ahrs(), imuData(), sampledAt(0),
+          timestampAtRead(timestampAtRead) {
         memset(gyroOffsets, 0, sizeof(float) * ImuXyz);
     }
 
@@ -27,7 +30,8 @@ namespace imu {
         float& qx = imuData.quat[1];
         float& qy = imuData.quat[2];
         float& qz = imuData.quat[3];
-        
+
+        uint64_t readAt = esp_timer_get_time();
         m5Imu.getAccelData(&ax, &ay, &az);
         m5Imu.getGyroData(&gx, &gy, &gz);
 
@@ -40,6 +44,7 @@ namespace imu {
             ax, ay, az,
             qw, qx, qy, qz);
         imuData.timestamp = millis();
+        sampledAt = timestampAtRead ? readAt : esp_timer_get_time();
         lastUpdated = imuData.timestamp;
         return true;
     }
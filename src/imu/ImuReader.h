@@ -12,16 +12,19 @@ namespace imu {
 
 class ImuReader {
 public:
-    explicit ImuReader(IMU& m5);
+    explicit ImuReader(IMU& m5, bool timestampAtRead = false);
     bool initialize();
     bool writeGyroOffset(float x, float y, float z);
     bool update();
     bool read(ImuData& outImuData) const;
+    uint64_t sampledMicros() const { return sampledAt; }
 private:
     IMU& m5Imu;
     mahony::MahonyAHRS ahrs;
     ImuData imuData;
     uint32_t lastUpdated;
+    uint64_t sampledAt;
+    bool timestampAtRead;
     float gyroOffsets[ImuXyz];
 };
 
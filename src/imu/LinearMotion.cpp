@@ -0,0 +1,76 @@
+#include <math.h>
+#include <string.h>
+#include "LinearMotion.h"
+
+namespace imu {
+
+    LinearMotion::LinearMotion(const LinearMotionConfig& config) : config(config) {
+        reset();
+    }
+
+    void LinearMotion::reset() {
+        dt = 1.0F / config.sampleHz;
+        stationaryAccSq = config.stationaryAcc * config.stationaryAcc;
+        filteredAccSq = 0.0F;
+        memset(velocity, 0, sizeof(float) * ImuXyz);
+        memset(lastAcc, 0, sizeof(float) * ImuXyz);
+        memset(bias, 0, sizeof(float) * ImuXyz);
+        stillCount = 0;
+    }
+
+    void LinearMotion::update(const ImuData& imuData, ImuMotionData& outMotion) {
+        const float ax = imuData.acc[0];
+        const float ay = imuData.acc[1];
+        const float az = imuData.acc[2];
+        const float q0 = imuData.quat[0];
+        const float q1 = imuData.quat[1];
+        const float q2 = imuData.quat[2];
+        const float q3 = imuData.quat[3];
+
+        // body to world, the last row is the gravity direction of the mahony filter
+        const float q1q1 = q1 * q1, q2q2 = q2 * q2, q3q3 = q3 * q3;
+        const float q0q1 = q0 * q1, q0q2 = q0 * q2, q0q3 = q0 * q3;
+        const float q1q2 = q1 * q2, q1q3 = q1 * q3, q2q3 = q2 * q3;
+        float acc[ImuXyz];
+        acc[0] = (1.0F - 2.0F * (q2q2 + q3q3)) * ax + 2.0F * (q1q2 - q0q3) * ay + 2.0F * (q1q3 + q0q2) * az;
+        acc[1] = 2.0F * (q1q2 + q0q3) * ax + (1.0F - 2.0F * (q1q1 + q3q3)) * ay + 2.0F * (q2q3 - q0q1) * az;
+        acc[2] = 2.0F * (q1q3 - q0q2) * ax + 2.0F * (q2q3 + q0q1) * ay + (1.0F - 2.0F * (q1q1 + q2q2)) * az;
+        acc[2] -= 1.0F;
+
+        float linear[ImuXyz];
+        float accSq = 0.0F;
+        for (int i = 0; i < ImuXyz; i++) {
+            linear[i] = acc[i] - bias[i];
+            accSq += linear[i] * linear[i];
+        }
+
+        // stationary: no linear acc and no rotation for a while
+        filteredAccSq += config.stationaryFilter * (accSq - filteredAccSq);
+        const float* g = imuData.gyro;
+        const bool still = filteredAccSq < stationaryAccSq &&
+                           fabsf(g[0]) < config.stationaryGyro &&
+                           fabsf(g[1]) < config.stationaryGyro &&
+                           fabsf(g[2]) < config.stationaryGyro;
+        stillCount = still ? stillCount + 1 : 0;
+        const bool stationary = stillCount >= config.stationarySamples;
+
+        for (int i = 0; i < ImuXyz; i++) {
+            if (stationary) {
+                // what is left while still comes from the attitude and the sensor
+                bias[i] += config.biasRate * (acc[i] - bias[i]);
+                velocity[i] = 0.0F;
+                outMotion.linearAcc[i] = 0.0F;
+            } else {
+                const float current = linear[i] * config.gravity;
+                // trapezoid
+                velocity[i] += 0.5F * (current + lastAcc[i]) * dt;
+                outMotion.linearAcc[i] = current;
+            }
+            lastAcc[i] = outMotion.linearAcc[i];
+            outMotion.velocity[i] = velocity[i];
+        }
+        outMotion.imu = imuData;
+        outMotion.flags = stationary ? MotionFlagStationary : 0;
+    }
+
+} // imu
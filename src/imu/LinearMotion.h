@@ -0,0 +1,42 @@
+#ifndef __IMU_LINEAR_MOTION_H__
+#define __IMU_LINEAR_MOTION_H__
+
+#include <inttypes.h>
+#include "ImuData.h"
+#include "ImuMotionData.h"
+
+namespace imu {
+
+struct LinearMotionConfig {
+public:
+    float sampleHz = 200.0F;         // same as the mahony sampleFreq
+    float gravity = 9.80665F;        // [m/s^2] per 1[g]
+    float stationaryAcc = 0.05F;     // [g] of the linear acc
+    float stationaryGyro = 5.0F;     // [deg/s] on each axis
+    int stationarySamples = 20;      // 0.1[s] at 200[Hz]
+    float stationaryFilter = 0.1F;   // low pass of the linear acc for the decision
+    float biasRate = 0.02F;          // bias learning while stationary
+};
+
+// Rotates acc into the world frame with the fused quaternion, removes gravity
+// and integrates velocity. The velocity is reset while the device stays still
+// (zero velocity update) and the residual acc is learned as a bias there.
+class LinearMotion {
+public:
+    explicit LinearMotion(const LinearMotionConfig& config = LinearMotionConfig());
+    void reset();
+    void update(const ImuData& imuData, ImuMotionData& outMotion);
+private:
+    LinearMotionConfig config;
+    float dt;
+    float stationaryAccSq;
+    float filteredAccSq;
+    float velocity[ImuXyz];
+    float lastAcc[ImuXyz];
+    float bias[ImuXyz];        // [g]
+    int stillCount;
+};
+
+} // imu
+
+#endif // __IMU_LINEAR_MOTION_H__
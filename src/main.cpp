@@ -1,12 +1,22 @@
 #include <M5stickC.h>
 #include <WiFi.h>
 #include <WiFiUdp.h>
+#include <esp_timer.h>
 #include "imu/ImuReader.h"
 #include "imu/AverageCalc.h"
+#include "imu/ImuBatchData.h"
+#include "imu/ImuMotionData.h"
+#include "imu/LinearMotion.h"
 #include "input/ButtonCheck.h"
 #include "input/ButtonData.h"
 #include "session/SessionData.h"
 #include "prefs/Settings.h"
+#include "profile/CycleProfiler.h"
+#include "profile/TelemetryData.h"
+#include "timesync/ClockSync.h"
+#include "timesync/TimeSyncData.h"
+#include "power/PowerProfile.h"
+#include "gesture/GestureDetector.h"
 
 // wifi
 #define SEND_DATA_NUM 4
@@ -14,6 +24,7 @@
 #define PASSWORD ""
 #define CLIENT_ADDRESS ""  // for send
 #define CLIENT_PORT 22222  // for send
+#define SERVER_PORT 22223  // for receive
 
 // tasks
 #define TASK_DEFAULT_CORE_ID 1
@@ -21,11 +32,29 @@
 #define TASK_NAME_IMU "IMUTask"
 #define TASK_NAME_WRITE_SESSION "WriteSessionTask"
 #define TASK_NAME_BUTTON "ButtonTask"
+#define TASK_NAME_READ_SESSION "ReadSessionTask"
 #define TASK_SLEEP_IMU 5             // = 1000[ms] / 200[Hz]
-#define TASK_SLEEP_WRITE_SESSION 5   // = 1000[ms] / 200[Hz]
-#define TASK_SLEEP_BUTTON 1          // = 1000[ms] / 1000[Hz]
 #define MUTEX_DEFAULT_WAIT 1000UL
 
+// telemetry
+#define TELEMETRY_INTERVAL 1000      // [ms]
+
+// power
+#define POWER_PROFILE power::PowerProfileLatency
+
+// motion
+#define LINEAR_MOTION false          // true: imuMotion frames instead of imu, not batched
+
+// gesture
+#define GESTURE_DETECTION true
+#define GESTURE_QUEUE_LEN 4
+#define SEND_RAW_IMU true            // false: gesture events only
+
+// time sync
+#define IMU_TIMESTAMP_AT_READ true   // false: after the fusion
+#define SEND_TIMED_DATA true         // timed frames once synced
+#define TIME_SYNC_TIMEOUT 100        // [ms] = SyncMaxRoundTrip
+
 void initM5LCD();
 void initGyro();
 void initWifi();
@@ -33,16 +62,36 @@ static void ImuLoop(void* arg);
 static void WriteSessionLoop(void* arg);
 static void ReadSessionLoop(void* arg);
 static void ButtonLoop(void* arg);
+static void writeTelemetry(session::SessionData& sessionData);
+static void writeTimeSyncRequest(session::SessionData& sessionData);
+static bool toSharedMicros(uint64_t local, uint64_t& outShared);
 
 imu::ImuReader* imuReader;
 WiFiUDP udp;
+WiFiUDP udpRead;
 input::ButtonCheck button;
 
 imu::ImuData imuData;
+imu::ImuBatchData imuBatch;
+imu::ImuMotionData imuMotion;
+imu::LinearMotion linearMotion;
 input::ButtonData btnData;
+uint64_t imuMicros = 0;
+uint64_t btnMicros = 0;
 bool hasButtonUpdate = false;
+gesture::GestureDetector gestureDetector;
+gesture::GestureData gestureQueue[GESTURE_QUEUE_LEN];
+uint64_t gestureMicros[GESTURE_QUEUE_LEN] = {0};
+int gestureCount = 0;
 static SemaphoreHandle_t imuDataMutex = NULL;
 static SemaphoreHandle_t btnDataMutex = NULL;
+static SemaphoreHandle_t clockSyncMutex = NULL;
+static TaskHandle_t taskHandles[profile::TelemetryTaskNum] = {NULL};
+profile::CycleProfiler profiler;
+timesync::ClockSync clockSync;
+const power::PowerSetting& powerSetting = power::PowerSettings[POWER_PROFILE];
+static_assert(!LINEAR_MOTION || power::PowerSettings[POWER_PROFILE].batchSize <= 1,
+              "imuMotion frames are sent one by one, use a profile without batching");
 
 bool gyroOffsetInstalled = true;
 imu::AverageCalcXYZ gyroAve;
@@ -60,16 +109,28 @@ void setup() {
     initWifi();
 
     M5.Lcd.println(WiFi.localIP());
+    M5.Lcd.println(powerSetting.name);
+    power::applyPowerSetting(powerSetting);
 
     imuDataMutex = xSemaphoreCreateMutex();
     btnDataMutex = xSemaphoreCreateMutex();
+    clockSyncMutex = xSemaphoreCreateMutex();
+    udpRead.begin(SERVER_PORT);
     xTaskCreatePinnedToCore(ImuLoop, TASK_NAME_IMU, TASK_STACK_DEPTH, NULL, 2,
-                            NULL, TASK_DEFAULT_CORE_ID);
+                            &taskHandles[profile::TelemetryTaskImu],
+                            TASK_DEFAULT_CORE_ID);
     xTaskCreatePinnedToCore(WriteSessionLoop, TASK_NAME_WRITE_SESSION,
-                            TASK_STACK_DEPTH, NULL, 1, NULL,
+                            TASK_STACK_DEPTH, NULL, 1,
+                            &taskHandles[profile::TelemetryTaskWriteSession],
                             TASK_DEFAULT_CORE_ID);
     xTaskCreatePinnedToCore(ButtonLoop, TASK_NAME_BUTTON, TASK_STACK_DEPTH,
-                            NULL, 1, NULL, TASK_DEFAULT_CORE_ID);
+                            NULL, 1,
+                            &taskHandles[profile::TelemetryTaskButton],
+                            TASK_DEFAULT_CORE_ID);
+    xTaskCreatePinnedToCore(ReadSessionLoop, TASK_NAME_READ_SESSION,
+                            TASK_STACK_DEPTH, NULL, 1,
+                            &taskHandles[profile::TelemetryTaskReadSession],
+                            TASK_DEFAULT_CORE_ID);
 }
 
 void loop() {
@@ -89,7 +150,7 @@ void initGyro() {
     settingPref.readGyroOffset(gyroOffset);
     settingPref.finish();
 
-    imuReader = new imu::ImuReader(M5.Imu);
+    imuReader = new imu::ImuReader(M5.Imu, IMU_TIMESTAMP_AT_READ);
     imuReader->initialize();
     if (gyroOffsetInstalled) {
         imuReader->writeGyroOffset(gyroOffset[0], gyroOffset[1], gyroOffset[2]);
@@ -114,9 +175,34 @@ void initWifi() {
 static void ImuLoop(void* arg) {
     while (1) {
         uint32_t entryTime = millis();
+        uint32_t waitStart = profile::CycleProfiler::now();
         if (xSemaphoreTake(imuDataMutex, MUTEX_DEFAULT_WAIT) == pdTRUE) {
+            profiler.record(profile::TelemetrySectionImuMutexWait, waitStart);
+            uint32_t updateStart = profile::CycleProfiler::now();
             imuReader->update();
+            profiler.record(profile::TelemetrySectionImuUpdate, updateStart);
             imuReader->read(imuData);
+            imuMicros = imuReader->sampledMicros();
+            if (LINEAR_MOTION) {
+                uint32_t motionStart = profile::CycleProfiler::now();
+                linearMotion.update(imuData, imuMotion);
+                profiler.record(profile::TelemetrySectionLinearMotion, motionStart);
+            }
+            if (powerSetting.batchSize > 1) {
+                imuBatch.push(imuData, imuMicros);
+            }
+            gesture::GestureData detected;
+            bool hasGesture = false;
+            if (GESTURE_DETECTION) {
+                uint32_t gestureStart = profile::CycleProfiler::now();
+                hasGesture = gestureDetector.update(imuData, detected);
+                profiler.record(profile::TelemetrySectionGesture, gestureStart);
+            }
+            if (hasGesture && gestureCount < GESTURE_QUEUE_LEN) {
+                gestureQueue[gestureCount] = detected;
+                gestureMicros[gestureCount] = imuMicros;
+                gestureCount++;
+            }
             if (!gyroOffsetInstalled) {
                 if (!gyroAve.push(imuData.gyro[0], imuData.gyro[1],
                                   imuData.gyro[2])) {
@@ -146,35 +232,174 @@ static void ImuLoop(void* arg) {
 static void WriteSessionLoop(void* arg) {
     static session::SessionData imuSessionData(session::DataDefineImu);
     static session::SessionData btnSessionData(session::DataDefineButton);
+    static session::SessionData telemetrySessionData(session::DataDefineTelemetry);
+    static session::SessionData timedImuSessionData(session::DataDefineTimedImu);
+    static session::SessionData timedBtnSessionData(session::DataDefineTimedButton);
+    static session::SessionData timeSyncSessionData(session::DataDefineTimeSyncRequest);
+    static session::SessionData imuBatchSessionData(session::DataDefineImuBatch);
+    static session::SessionData gestureSessionData(session::DataDefineGesture);
+    static session::SessionData imuMotionSessionData(session::DataDefineImuMotion);
+    static session::SessionData timedGestureSessionData(session::DataDefineTimedGesture);
+    static timesync::TimedImuData timedImuData;
+    static timesync::TimedButtonData timedBtnData;
+    static timesync::TimedGestureData timedGestureData;
+    uint32_t lastTelemetry = millis();
+    uint32_t lastTimeSync = millis();
     while (1) {
         uint32_t entryTime = millis();
         // imu
-        if (gyroOffsetInstalled) {
+        if (SEND_RAW_IMU && gyroOffsetInstalled) {
+            uint32_t waitStart = profile::CycleProfiler::now();
             if (xSemaphoreTake(imuDataMutex, MUTEX_DEFAULT_WAIT) == pdTRUE) {
-                udp.beginPacket(CLIENT_ADDRESS, CLIENT_PORT);
-                imuSessionData.write((uint8_t*)&imuData, imu::ImuDataLen);
-                udp.write((uint8_t*)&imuSessionData, imuSessionData.length());
-                udp.endPacket();
+                profiler.record(profile::TelemetrySectionSessionImuMutexWait, waitStart);
+                if (powerSetting.batchSize > 1) {
+                    // send once the batch is full
+                    if (imuBatch.count >= powerSetting.batchSize) {
+                        uint64_t shared = 0;
+                        if (SEND_TIMED_DATA && toSharedMicros(imuBatch.micros, shared)) {
+                            imuBatch.micros = shared;
+                            imuBatch.flags |= imu::ImuBatchFlagShared;
+                        }
+                        udp.beginPacket(CLIENT_ADDRESS, CLIENT_PORT);
+                        imuBatchSessionData.write((uint8_t*)&imuBatch, imuBatch.length());
+                        udp.write((uint8_t*)&imuBatchSessionData, imuBatchSessionData.length());
+                        uint32_t sendStart = profile::CycleProfiler::now();
+                        udp.endPacket();
+                        profiler.record(profile::TelemetrySectionUdpEndPacket, sendStart);
+                        imuBatch.clear();
+                    }
+                } else {
+                    udp.beginPacket(CLIENT_ADDRESS, CLIENT_PORT);
+                    if (LINEAR_MOTION) {
+                        // set on every send, a resent sample follows the current sync state
+                        if (SEND_TIMED_DATA && toSharedMicros(imuMicros, imuMotion.micros)) {
+                            imuMotion.flags |= imu::MotionFlagShared;
+                        } else {
+                            imuMotion.micros = imuMicros;
+                            imuMotion.flags &= ~imu::MotionFlagShared;
+                        }
+                        imuMotionSessionData.write((uint8_t*)&imuMotion, imu::ImuMotionDataLen);
+                        udp.write((uint8_t*)&imuMotionSessionData, imuMotionSessionData.length());
+                    } else if (SEND_TIMED_DATA && toSharedMicros(imuMicros, timedImuData.micros)) {
+                        timedImuData.imu = imuData;
+                        timedImuSessionData.write((uint8_t*)&timedImuData, timesync::TimedImuDataLen);
+                        udp.write((uint8_t*)&timedImuSessionData, timedImuSessionData.length());
+                    } else {
+                        imuSessionData.write((uint8_t*)&imuData, imu::ImuDataLen);
+                        udp.write((uint8_t*)&imuSessionData, imuSessionData.length());
+                    }
+                    uint32_t sendStart = profile::CycleProfiler::now();
+                    udp.endPacket();
+                    profiler.record(profile::TelemetrySectionUdpEndPacket, sendStart);
+                }
             }
             xSemaphoreGive(imuDataMutex);
         }
+        // gesture
+        if (GESTURE_DETECTION) {
+            if (xSemaphoreTake(imuDataMutex, MUTEX_DEFAULT_WAIT) == pdTRUE) {
+                for (int i = 0; i < gestureCount; i++) {
+                    udp.beginPacket(CLIENT_ADDRESS, CLIENT_PORT);
+                    if (SEND_TIMED_DATA && toSharedMicros(gestureMicros[i], timedGestureData.micros)) {
+                        timedGestureData.gesture = gestureQueue[i];
+                        timedGestureSessionData.write((uint8_t*)&timedGestureData, timesync::TimedGestureDataLen);
+                        udp.write((uint8_t*)&timedGestureSessionData, timedGestureSessionData.length());
+                    } else {
+                        gestureSessionData.write((uint8_t*)&gestureQueue[i], gesture::GestureDataLen);
+                        udp.write((uint8_t*)&gestureSessionData, gestureSessionData.length());
+                    }
+                    udp.endPacket();
+                }
+                gestureCount = 0;
+                xSemaphoreGive(imuDataMutex);
+            }
+        }
         // button
+        uint32_t waitStart = profile::CycleProfiler::now();
         if (xSemaphoreTake(btnDataMutex, MUTEX_DEFAULT_WAIT) == pdTRUE) {
+            profiler.record(profile::TelemetrySectionSessionButtonMutexWait, waitStart);
             if (hasButtonUpdate) {
                 udp.beginPacket(CLIENT_ADDRESS, CLIENT_PORT);
-                btnSessionData.write((uint8_t*)&btnData, input::ButtonDataLen);
-                udp.write((uint8_t*)&btnSessionData, btnSessionData.length());
+                if (SEND_TIMED_DATA && toSharedMicros(btnMicros, timedBtnData.micros)) {
+                    timedBtnData.button = btnData;
+                    timedBtnSessionData.write((uint8_t*)&timedBtnData, timesync::TimedButtonDataLen);
+                    udp.write((uint8_t*)&timedBtnSessionData, timedBtnSessionData.length());
+                } else {
+                    btnSessionData.write((uint8_t*)&btnData, input::ButtonDataLen);
+                    udp.write((uint8_t*)&btnSessionData, btnSessionData.length());
+                }
+                uint32_t sendStart = profile::CycleProfiler::now();
                 udp.endPacket();
+                profiler.record(profile::TelemetrySectionUdpEndPacket, sendStart);
                 hasButtonUpdate = false;
             }
             xSemaphoreGive(btnDataMutex);
         }
+        // telemetry
+        if (millis() - lastTelemetry >= TELEMETRY_INTERVAL) {
+            writeTelemetry(telemetrySessionData);
+            lastTelemetry = millis();
+        }
+        // time sync
+        if (millis() - lastTimeSync >= powerSetting.timeSyncInterval) {
+            writeTimeSyncRequest(timeSyncSessionData);
+            lastTimeSync = millis();
+        }
         // idle
-        int32_t sleep = TASK_SLEEP_WRITE_SESSION - (millis() - entryTime);
+        int32_t sleep = powerSetting.sendInterval - (millis() - entryTime);
         vTaskDelay((sleep > 0) ? sleep : 0);
     }
 }
 
+static void ReadSessionLoop(void* arg) {
+    static uint8_t buffer[session::data_length::header + session::data_length::max];
+    bool awaiting = false;
+    uint32_t awaitStart = 0;
+    while (1) {
+        uint32_t entryTime = millis();
+        if (udpRead.parsePacket() > 0) {
+            uint64_t receivedAt = esp_timer_get_time();
+            int len = udpRead.read(buffer, sizeof(buffer));
+            uint16_t dataType = 0;
+            uint16_t dataLength = 0;
+            if (len >= session::data_length::header) {
+                memcpy(&dataType, buffer, sizeof(uint16_t));
+                memcpy(&dataLength, buffer + sizeof(uint16_t), sizeof(uint16_t));
+            }
+            if (dataType == session::data_type::timeSyncResponse &&
+                dataLength == session::data_length::timeSyncResponse &&
+                len >= session::data_length::header + dataLength) {
+                timesync::TimeSyncData response;
+                memcpy(&response, buffer + session::data_length::header,
+                       timesync::TimeSyncDataLen);
+                if (xSemaphoreTake(clockSyncMutex, MUTEX_DEFAULT_WAIT) == pdTRUE) {
+                    clockSync.update(response, receivedAt);
+                    xSemaphoreGive(clockSyncMutex);
+                }
+                power::holdRadioAwake(powerSetting, false);
+                awaiting = false;
+            }
+        }
+        if (awaiting && millis() - awaitStart >= TIME_SYNC_TIMEOUT) {
+            power::holdRadioAwake(powerSetting, false);
+            awaiting = false;
+        }
+        if (awaiting) {
+            // spin while a response is awaited to stamp it right at receipt,
+            // the tasks of the same priority still run
+            taskYIELD();
+            continue;
+        }
+        // idle
+        int32_t sleep = powerSetting.pollInterval - (millis() - entryTime);
+        if (ulTaskNotifyTake(pdTRUE, (sleep > 0) ? sleep : 0) > 0) {
+            // a request was sent
+            awaiting = true;
+            awaitStart = millis();
+        }
+    }
+}
+
 static void ButtonLoop(void* arg) {
     uint8_t btnFlag = 0;
     while (1) {
@@ -185,6 +410,7 @@ static void ButtonLoop(void* arg) {
                 if (xSemaphoreTake(btnDataMutex, MUTEX_DEFAULT_WAIT) ==
                     pdTRUE) {
                     btnData.timestamp = millis();
+                    btnMicros = esp_timer_get_time();
                     btnData.btnBits = btnFlag;
                     hasButtonUpdate = true;
                 }
@@ -192,7 +418,67 @@ static void ButtonLoop(void* arg) {
             }
         }
         // idle
-        int32_t sleep = TASK_SLEEP_BUTTON - (millis() - entryTime);
+        int32_t sleep = powerSetting.pollInterval - (millis() - entryTime);
         vTaskDelay((sleep > 0) ? sleep : 0);
     }
 }
+
+static void writeTelemetry(session::SessionData& sessionData) {
+    profile::TelemetryData telemetry;
+    telemetry.timestamp = millis();
+    telemetry.freeHeap = ESP.getFreeHeap();
+    telemetry.minFreeHeap = ESP.getMinFreeHeap();
+    telemetry.cpuMhz = power::isFrequencyScaled() ? 0 : getCpuFrequencyMhz();
+    for (int i = 0; i < profile::TelemetryTaskNum; i++) {
+        if (taskHandles[i] != NULL) {
+            telemetry.stackHighWater[i] =
+                uxTaskGetStackHighWaterMark(taskHandles[i]);
+        }
+    }
+    // one frame per section, heap and stack values are repeated in each
+    for (int i = 0; i < profile::TelemetrySectionNum; i++) {
+        profile::SectionStats stats;
+        profiler.takeSnapshot((profile::TelemetrySection)i, stats);
+        telemetry.section = i;
+        telemetry.count = (stats.count > UINT16_MAX) ? UINT16_MAX : stats.count;
+        telemetry.maxCycles = stats.maxCycles;
+        telemetry.sumCycles = stats.sumCycles;
+        memcpy(telemetry.buckets, stats.buckets,
+               sizeof(uint16_t) * profile::TelemetryBucketNum);
+        udp.beginPacket(CLIENT_ADDRESS, CLIENT_PORT);
+        sessionData.write((uint8_t*)&telemetry, profile::TelemetryDataLen);
+        udp.write((uint8_t*)&sessionData, sessionData.length());
+        udp.endPacket();
+    }
+}
+
+static void writeTimeSyncRequest(session::SessionData& sessionData) {
+    static timesync::TimeSyncData request;
+    request.sequence++;
+    // the response is not held back until the next wake up of the radio
+    power::holdRadioAwake(powerSetting, true);
+    udp.beginPacket(CLIENT_ADDRESS, CLIENT_PORT);
+    request.originate = esp_timer_get_time();
+    if (xSemaphoreTake(clockSyncMutex, MUTEX_DEFAULT_WAIT) == pdTRUE) {
+        clockSync.requestSent(request);
+        xSemaphoreGive(clockSyncMutex);
+    }
+    sessionData.write((uint8_t*)&request, timesync::TimeSyncDataLen);
+    udp.write((uint8_t*)&sessionData, sessionData.length());
+    udp.endPacket();
+    if (taskHandles[profile::TelemetryTaskReadSession] != NULL) {
+        xTaskNotifyGive(taskHandles[profile::TelemetryTaskReadSession]);
+    }
+}
+
+static bool toSharedMicros(uint64_t local, uint64_t& outShared) {
+    bool synced = false;
+    if (xSemaphoreTake(clockSyncMutex, MUTEX_DEFAULT_WAIT) == pdTRUE) {
+        synced = clockSync.isSynced();
+        if (synced) {
+            outShared = clockSync.toShared(local);
+        }
+        xSemaphoreGive(clockSyncMutex);
+    }
+    return synced;
+}
@@ -0,0 +1,65 @@
+#include <Arduino.h>
+#include <WiFi.h>
+#include <esp_wifi.h>
+#include <esp_pm.h>
+#include "PowerProfile.h"
+
+namespace power {
+
+    static bool frequencyScaled = false;
+
+    static wifi_ps_type_t toWifiPs(PowerSave powerSave) {
+        switch (powerSave) {
+        case PowerSaveMinModem:
+            return WIFI_PS_MIN_MODEM;
+        case PowerSaveMaxModem:
+            return WIFI_PS_MAX_MODEM;
+        default:
+            return WIFI_PS_NONE;
+        }
+    }
+
+    bool applyPowerSetting(const PowerSetting& setting) {
+        bool applied = setCpuFrequencyMhz(setting.cpuMhz);
+        if (setting.powerSave == PowerSaveMaxModem) {
+            // WiFi.begin() rewrites the sta config, and the listen interval
+            // is sent on association, so reconnect with it
+            wifi_config_t config;
+            if (esp_wifi_get_config(ESP_IF_WIFI_STA, &config) == ESP_OK &&
+                config.sta.listen_interval != setting.listenInterval) {
+                config.sta.listen_interval = setting.listenInterval;
+                applied &= (esp_wifi_set_config(ESP_IF_WIFI_STA, &config) == ESP_OK);
+                applied &= WiFi.reconnect();
+                delay(500);
+                while (WiFi.status() != WL_CONNECTED) {
+                    delay(500);
+                }
+            }
+        }
+        applied &= (esp_wifi_set_ps(toWifiPs(setting.powerSave)) == ESP_OK);
+#if CONFIG_PM_ENABLE
+        esp_pm_config_esp32_t pm;
+        pm.max_freq_mhz = setting.cpuMhz;
+        pm.min_freq_mhz = 40; // xtal, the lowest with wifi
+        pm.light_sleep_enable = setting.lightSleep;
+        if (esp_pm_configure(&pm) == ESP_OK) {
+            frequencyScaled = (pm.min_freq_mhz != pm.max_freq_mhz);
+        } else {
+            applied = false;
+        }
+#endif
+        return applied;
+    }
+
+    bool holdRadioAwake(const PowerSetting& setting, bool awake) {
+        if (setting.powerSave == PowerSaveNone) {
+            return true;
+        }
+        return esp_wifi_set_ps(awake ? WIFI_PS_NONE : toWifiPs(setting.powerSave)) == ESP_OK;
+    }
+
+    bool isFrequencyScaled() {
+        return frequencyScaled;
+    }
+
+} // power
@@ -0,0 +1,53 @@
+#ifndef __POWER_POWER_PROFILE_H__
+#define __POWER_POWER_PROFILE_H__
+
+#include <inttypes.h>
+
+namespace power {
+
+enum PowerProfile {
+    PowerProfileLatency = 0,
+    PowerProfileBalanced = 1,
+    PowerProfileLowPower = 2
+};
+
+enum PowerSave {
+    PowerSaveNone = 0,      // radio always on
+    PowerSaveMinModem = 1,  // radio wakes every DTIM
+    PowerSaveMaxModem = 2   // radio wakes every listenInterval beacons
+};
+
+static const int PowerProfileNum = 3;
+
+struct PowerSetting {
+public:
+    const char* name;
+    uint16_t cpuMhz;
+    PowerSave powerSave;
+    uint8_t listenInterval;     // [beacon]
+    uint8_t batchSize;          // imu samples per packet
+    bool lightSleep;            // auto light sleep, needs CONFIG_PM_ENABLE
+    uint32_t timeSyncInterval;  // [ms]
+    uint16_t pollInterval;      // [ms] button and read session loops
+    uint16_t sendInterval;      // [ms] write session loop, batchSize samples
+};
+
+static constexpr PowerSetting PowerSettings[PowerProfileNum] = {
+    { "latency",  240, PowerSaveNone,     0, 1, false, 250,  1,  5 },
+    { "balanced", 160, PowerSaveMinModem, 1, 4, false, 1000, 10, 20 },
+    { "lowpower",  80, PowerSaveMaxModem, 3, 8, true,  5000, 50, 40 },
+};
+
+// device only, call after the wifi is connected. Reconnects and waits for it
+// when the listenInterval has to be applied.
+bool applyPowerSetting(const PowerSetting& setting);
+// device only, takes the radio out of power save for a time sync exchange,
+// else the access point holds the response until the next DTIM or listen
+// interval wake up. false puts it back to the power save of the setting.
+bool holdRadioAwake(const PowerSetting& setting, bool awake);
+// true once esp_pm scales the cpu clock, a cycle count is no longer a time
+bool isFrequencyScaled();
+
+} // power
+
+#endif // __POWER_POWER_PROFILE_H__
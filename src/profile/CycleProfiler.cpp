@@ -0,0 +1,39 @@
+#include "CycleProfiler.h"
+
+namespace profile {
+
+    CycleProfiler::CycleProfiler() {
+        memset(stats, 0, sizeof(SectionStats) * TelemetrySectionNum);
+        statsMux = portMUX_INITIALIZER_UNLOCKED;
+    }
+
+    void CycleProfiler::record(TelemetrySection section, uint32_t startCycles) {
+        uint32_t cycles = now() - startCycles;
+        int bucket = 0;
+        if ((cycles >> TelemetryBucketShift) != 0) {
+            bucket = 32 - __builtin_clz(cycles) - TelemetryBucketShift;
+            if (bucket >= TelemetryBucketNum) {
+                bucket = TelemetryBucketNum - 1;
+            }
+        }
+        SectionStats& s = stats[section];
+        portENTER_CRITICAL(&statsMux);
+        s.count++;
+        s.sumCycles += cycles;
+        if (cycles > s.maxCycles) {
+            s.maxCycles = cycles;
+        }
+        if (s.buckets[bucket] != UINT16_MAX) {
+            s.buckets[bucket]++;
+        }
+        portEXIT_CRITICAL(&statsMux);
+    }
+
+    void CycleProfiler::takeSnapshot(TelemetrySection section, SectionStats& outStats) {
+        portENTER_CRITICAL(&statsMux);
+        memcpy(&outStats, &stats[section], sizeof(SectionStats));
+        memset(&stats[section], 0, sizeof(SectionStats));
+        portEXIT_CRITICAL(&statsMux);
+    }
+
+} // profile
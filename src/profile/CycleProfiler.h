@@ -0,0 +1,32 @@
+#ifndef __PROFILE_CYCLE_PROFILER_H__
+#define __PROFILE_CYCLE_PROFILER_H__
+
+#include <Arduino.h>
+#include "TelemetryData.h"
+
+namespace profile {
+
+struct SectionStats {
+public:
+    uint32_t count;
+    uint32_t maxCycles;
+    uint32_t sumCycles;
+    uint16_t buckets[TelemetryBucketNum];
+};
+
+// Fixed memory cycle counter histograms. record() is a couple of cycle counter
+// reads and a clz, so it is cheap enough to stay enabled in production.
+class CycleProfiler {
+public:
+    explicit CycleProfiler();
+    static uint32_t now() { return ESP.getCycleCount(); }
+    void record(TelemetrySection section, uint32_t startCycles);
+    void takeSnapshot(TelemetrySection section, SectionStats& outStats);
+private:
+    SectionStats stats[TelemetrySectionNum];
+    portMUX_TYPE statsMux;
+};
+
+} // profile
+
+#endif // __PROFILE_CYCLE_PROFILER_H__
@@ -0,0 +1,56 @@
+#ifndef __PROFILE_TELEMETRY_DATA_H__
+#define __PROFILE_TELEMETRY_DATA_H__
+
+#include <inttypes.h>
+#include <string.h>
+
+namespace profile {
+
+enum TelemetryTask {
+    TelemetryTaskImu = 0,
+    TelemetryTaskWriteSession = 1,
+    TelemetryTaskButton = 2,
+    TelemetryTaskReadSession = 3
+};
+
+enum TelemetrySection {
+    TelemetrySectionImuUpdate = 0,
+    TelemetrySectionImuMutexWait = 1,
+    TelemetrySectionSessionImuMutexWait = 2,
+    TelemetrySectionUdpEndPacket = 3,
+    TelemetrySectionSessionButtonMutexWait = 4,
+    TelemetrySectionLinearMotion = 5,
+    TelemetrySectionGesture = 6
+};
+
+static const int TelemetryTaskNum = 4;
+static const int TelemetrySectionNum = 7;
+static const int TelemetryBucketNum = 12;
+static const int TelemetryBucketShift = 10;
+static const int TelemetryDataLen = 60;//4 + 4 + 4 + (2*4) + 2 + 2 + 2 + 2 + 4 + 4 + (2*12);
+
+// bucket 0 counts samples below (1 << bucketShift) cycles, bucket i counts
+// [1 << (bucketShift + i - 1), 1 << (bucketShift + i)), the last one is open ended.
+struct TelemetryData {
+public:
+    uint32_t timestamp;
+    uint32_t freeHeap;
+    uint32_t minFreeHeap;
+    uint16_t stackHighWater[TelemetryTaskNum];
+    uint16_t section;
+    uint16_t count;
+    uint16_t cpuMhz;        // 0: scaled by esp_pm, the cycles do not convert to time
+    uint16_t bucketShift;
+    uint32_t maxCycles;
+    uint32_t sumCycles;
+    uint16_t buckets[TelemetryBucketNum];
+
+    explicit TelemetryData() {
+        memset(this, 0, TelemetryDataLen);
+        bucketShift = TelemetryBucketShift;
+    }
+};
+
+} // profile
+
+#endif // __PROFILE_TELEMETRY_DATA_H__
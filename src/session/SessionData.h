@@ -2,7 +2,7 @@
 #define __SESSION_SESSION_DATA_H__
 
 #include <inttypes.h>
-#include <Arduino.h>
+#include <string.h>
 #include "SessionHeader.h"
 
 namespace session {
@@ -16,6 +16,7 @@ public:
     }
     void write(const uint8_t* data, uint16_t len) {
         memcpy(this->data, data, len);
+        header.dataLength = len;
     }
     uint32_t length() const { return data_length::header + header.dataLength; }
 };
@@ -8,25 +8,51 @@ namespace session {
 enum DataDefine {
     DataDefineUnknown = 0,
     DataDefineImu = 1,
-    DataDefineButton = 2
+    DataDefineButton = 2,
+    DataDefineTelemetry = 3,
+    DataDefineTimeSyncRequest = 4,
+    DataDefineTimedImu = 5,
+    DataDefineTimedButton = 6,
+    DataDefineImuBatch = 7,
+    DataDefineGesture = 8,
+    DataDefineImuMotion = 9,
+    DataDefineTimedGesture = 10
 };
 
 namespace data_type {
 // send to client
 static const uint16_t imu = 0x0001;
 static const uint16_t button = 0x0002;
+static const uint16_t telemetry = 0x0003;
+static const uint16_t timeSyncRequest = 0x0004;
+static const uint16_t timedImu = 0x0005;
+static const uint16_t timedButton = 0x0006;
+static const uint16_t imuBatch = 0x0007;
+static const uint16_t gesture = 0x0008;
+static const uint16_t imuMotion = 0x0009;
+static const uint16_t timedGesture = 0x000A;
 // request form client
 static const uint16_t installGyroOffset = 0x8001;
+static const uint16_t timeSyncResponse = 0x8002;
 }
 
 namespace data_length {
-static const uint16_t max = 64;
+static const uint16_t max = 780;
 // send to client
 static const uint16_t header = 4;
 static const uint16_t imu = 44;
 static const uint16_t button = 5;
+static const uint16_t telemetry = 60;
+static const uint16_t timeSyncRequest = 32;
+static const uint16_t timedImu = 52;
+static const uint16_t timedButton = 13;
+static const uint16_t imuBatch = 780;  // 12 + (48 * count), up to 16
+static const uint16_t gesture = 12;
+static const uint16_t imuMotion = 80;
+static const uint16_t timedGesture = 20;
 // request form client
 static const uint16_t installGyroOffset = 0;
+static const uint16_t timeSyncResponse = 32;
 }
 
 } // session
@@ -21,6 +21,38 @@ public:
             dataType = data_type::button;
             dataLength = data_length::button;
             break;
+        case DataDefineTelemetry:
+            dataType = data_type::telemetry;
+            dataLength = data_length::telemetry;
+            break;
+        case DataDefineTimeSyncRequest:
+            dataType = data_type::timeSyncRequest;
+            dataLength = data_length::timeSyncRequest;
+            break;
+        case DataDefineTimedImu:
+            dataType = data_type::timedImu;
+            dataLength = data_length::timedImu;
+            break;
+        case DataDefineTimedButton:
+            dataType = data_type::timedButton;
+            dataLength = data_length::timedButton;
+            break;
+        case DataDefineImuBatch:
+            dataType = data_type::imuBatch;
+            dataLength = data_length::imuBatch;
+            break;
+        case DataDefineGesture:
+            dataType = data_type::gesture;
+            dataLength = data_length::gesture;
+            break;
+        case DataDefineImuMotion:
+            dataType = data_type::imuMotion;
+            dataLength = data_length::imuMotion;
+            break;
+        case DataDefineTimedGesture:
+            dataType = data_type::timedGesture;
+            dataLength = data_length::timedGesture;
+            break;
         default:
             dataType = 0;
             dataLength = 0;
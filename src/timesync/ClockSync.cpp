@@ -0,0 +1,131 @@
+#include <math.h>
+#include <string.h>
+#include "ClockSync.h"
+
+namespace timesync {
+
+    ClockSync::ClockSync() {
+        reset();
+    }
+
+    void ClockSync::reset() {
+        memset(samples, 0, sizeof(SyncSample) * SyncSampleNum);
+        memset(anchors, 0, sizeof(SyncSample) * SyncAnchorNum);
+        sampleCount = 0;
+        sampleHead = 0;
+        anchorCount = 0;
+        anchorHead = 0;
+        anchorLocal = 0;
+        anchorOffset = 0;
+        anchorRoundTrip = 0;
+        skew = 0.0;
+        hasPending = false;
+        pendingSequence = 0;
+        pendingOriginate = 0;
+    }
+
+    void ClockSync::requestSent(const TimeSyncData& request) {
+        hasPending = true;
+        pendingSequence = request.sequence;
+        pendingOriginate = request.originate;
+    }
+
+    bool ClockSync::update(const TimeSyncData& response, uint64_t localReceived) {
+        if (!hasPending || response.sequence != pendingSequence ||
+            response.originate != pendingOriginate) {
+            return false; // not the response to the outstanding request
+        }
+        hasPending = false;
+        const uint64_t t1 = response.originate;
+        const uint64_t t2 = response.receive;
+        const uint64_t t3 = response.transmit;
+        const uint64_t t4 = localReceived;
+        if (t4 < t1 || t3 < t2) {
+            return false; // broken response
+        }
+        const uint64_t total = t4 - t1;
+        const uint64_t hold = t3 - t2;
+        if (hold > total || total - hold > SyncMaxRoundTrip) {
+            return false; // skewed too much or delayed too long
+        }
+        SyncSample& sample = samples[sampleHead];
+        sample.local = t1 + total / 2;
+        sample.offset = ((int64_t)(t2 - t1) + (int64_t)(t3 - t4)) / 2;
+        sample.roundTrip = (uint32_t)(total - hold);
+        sampleHead = (sampleHead + 1) % SyncSampleNum;
+        if (sampleCount < SyncSampleNum) {
+            sampleCount++;
+        }
+        estimate();
+        if (sampleHead == 0) {
+            // the window is full, keep its best sample as history
+            anchors[anchorHead] = samples[findBest()];
+            anchorHead = (anchorHead + 1) % SyncAnchorNum;
+            if (anchorCount < SyncAnchorNum) {
+                anchorCount++;
+            }
+        }
+        return true;
+    }
+
+    uint64_t ClockSync::toShared(uint64_t local) const {
+        const int64_t elapsed = (int64_t)(local - anchorLocal);
+        return local + anchorOffset + (int64_t)(skew * (double)elapsed);
+    }
+
+    int ClockSync::findBest() const {
+        // the shortest round trip is the least disturbed by queueing
+        int best = 0;
+        for (int i = 1; i < sampleCount; i++) {
+            if (samples[i].roundTrip < samples[best].roundTrip) {
+                best = i;
+            }
+        }
+        return best;
+    }
+
+    void ClockSync::estimate() {
+        const SyncSample& anchor = samples[findBest()];
+        anchorLocal = anchor.local;
+        anchorOffset = anchor.offset;
+        anchorRoundTrip = anchor.roundTrip;
+        if (fitDrift(anchors, anchorCount, UINT32_MAX)) {
+            return;
+        }
+        fitDrift(samples, sampleCount, anchor.roundTrip + SyncRoundTripMargin);
+    }
+
+    bool ClockSync::fitDrift(const SyncSample* from, int count, uint32_t limit) {
+        double sx = 0.0, sy = 0.0, sxx = 0.0, sxy = 0.0;
+        double minX = 0.0, maxX = 0.0;
+        int n = 0;
+        for (int i = 0; i < count; i++) {
+            if (from[i].roundTrip > limit) {
+                continue;
+            }
+            // relative to the anchor to keep the precision of double
+            const double x = (double)(int64_t)(from[i].local - anchorLocal);
+            const double y = (double)(from[i].offset - anchorOffset);
+            sx += x;
+            sy += y;
+            sxx += x * x;
+            sxy += x * y;
+            minX = (n == 0 || x < minX) ? x : minX;
+            maxX = (n == 0 || x > maxX) ? x : maxX;
+            n++;
+        }
+        const double den = n * sxx - sx * sx;
+        if (n < 2 || den <= 0.0 || maxX - minX < (double)SyncMinDriftSpan) {
+            return false;
+        }
+        const double fitted = (n * sxy - sx * sy) / den;
+        if (fitted <= -SyncMaxDrift || fitted >= SyncMaxDrift) {
+            return false;
+        }
+        // the line averages the asymmetry of the single anchor out
+        skew = fitted;
+        anchorOffset += (int64_t)llround((sy - fitted * sx) / n);
+        return true;
+    }
+
+} // timesync
@@ -0,0 +1,68 @@
+#ifndef __TIMESYNC_CLOCK_SYNC_H__
+#define __TIMESYNC_CLOCK_SYNC_H__
+
+#include <inttypes.h>
+#include "TimeSyncData.h"
+
+namespace timesync {
+
+static const int SyncSampleNum = 16;
+static const int SyncAnchorNum = 16;
+static const uint32_t SyncMaxRoundTrip = 100000;  // [us]
+static const uint32_t SyncMaxAnchorRoundTrip = 10000;  // [us] to be synced
+static const int SyncMinSamples = 4;                  // to be synced
+static const uint32_t SyncRoundTripMargin = 500;   // [us]
+static const uint64_t SyncMinDriftSpan = 2000000;  // [us]
+static const double SyncMaxDrift = 0.0005;         // 500[ppm]
+
+struct SyncSample {
+public:
+    uint64_t local;      // [us] device clock, middle of the exchange
+    int64_t offset;      // [us] receiver - device
+    uint32_t roundTrip;  // [us]
+};
+
+// Maps the device clock to the receiver clock. Each exchange gives an offset
+// and a round trip, the sample with the shortest round trip in the recent
+// window is used as the anchor. The best sample of every full window is kept
+// as a long term history and the drift is fitted over it, the recent window
+// is used for the drift until the history spans long enough.
+// Synced once a few samples are in and the anchor round trip is short.
+// Only the response to the request passed to requestSent() is taken, a late
+// response to an earlier request is dropped.
+// Independent from the hardware, every clock is passed in [us].
+class ClockSync {
+public:
+    explicit ClockSync();
+    void reset();
+    void requestSent(const TimeSyncData& request);
+    bool update(const TimeSyncData& response, uint64_t localReceived);
+    bool isSynced() const {
+        return sampleCount >= SyncMinSamples && anchorRoundTrip <= SyncMaxAnchorRoundTrip;
+    }
+    uint64_t toShared(uint64_t local) const;
+    int64_t offset() const { return anchorOffset; }
+    double drift() const { return skew; }  // [us/us]
+    uint32_t roundTrip() const { return anchorRoundTrip; }
+private:
+    SyncSample samples[SyncSampleNum];
+    int sampleCount;
+    int sampleHead;
+    SyncSample anchors[SyncAnchorNum];
+    int anchorCount;
+    int anchorHead;
+    uint64_t anchorLocal;
+    int64_t anchorOffset;
+    uint32_t anchorRoundTrip;
+    double skew;
+    bool hasPending;
+    uint32_t pendingSequence;
+    uint64_t pendingOriginate;
+    int findBest() const;
+    void estimate();
+    bool fitDrift(const SyncSample* from, int count, uint32_t limit);
+};
+
+} // timesync
+
+#endif // __TIMESYNC_CLOCK_SYNC_H__
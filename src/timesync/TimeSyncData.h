@@ -0,0 +1,58 @@
+#ifndef __TIMESYNC_TIME_SYNC_DATA_H__
+#define __TIMESYNC_TIME_SYNC_DATA_H__
+
+#include <inttypes.h>
+#include <string.h>
+#include "../imu/ImuData.h"
+#include "../input/ButtonData.h"
+#include "../gesture/GestureData.h"
+
+namespace timesync {
+
+static const int TimeSyncDataLen = 32;//4 + 4 + 8 + 8 + 8;
+static const int TimedImuDataLen = 52;//8 + 44;
+static const int TimedButtonDataLen = 13;//8 + 5;
+static const int TimedGestureDataLen = 20;//8 + 12;
+
+// NTP style exchange. The device fills originate and sends a request,
+// the receiver fills receive and transmit with its own clock and sends it back.
+struct TimeSyncData {
+public:
+    uint32_t sequence;
+    uint32_t reserved;
+    uint64_t originate;  // [us] device clock, request sent
+    uint64_t receive;    // [us] receiver clock, request received
+    uint64_t transmit;   // [us] receiver clock, response sent
+
+    explicit TimeSyncData() {
+        memset(this, 0, TimeSyncDataLen);
+    }
+};
+
+struct TimedImuData {
+public:
+    uint64_t micros;     // [us] receiver clock
+    imu::ImuData imu;
+
+    explicit TimedImuData() : micros(0), imu() { }
+};
+
+struct TimedButtonData {
+public:
+    uint64_t micros;     // [us] receiver clock
+    input::ButtonData button;
+
+    explicit TimedButtonData() : micros(0), button() { }
+};
+
+struct TimedGestureData {
+public:
+    uint64_t micros;     // [us] receiver clock
+    gesture::GestureData gesture;
+
+    explicit TimedGestureData() : micros(0), gesture() { }
+};
+
+} // timesync
+
+#endif // __TIMESYNC_TIME_SYNC_DATA_H__